@@ -0,0 +1,248 @@
+// Copyright Hitbox Games, LLC. All Rights Reserved.
+
+#include "IReplicatedPhysicsModule.h"
+#include "PhysicsBucketBenchmarkTarget.h"
+#include "PhysicsBucketUpdateSubsystem.h"
+#include "HAL/FileManager.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/DateTime.h"
+#include "Misc/FileHelper.h"
+#include "Math/RandomStream.h"
+#include "Misc/AutomationTest.h"
+#include "Misc/Paths.h"
+#include "UObject/GCObjectScopeGuard.h"
+
+#if !UE_BUILD_SHIPPING
+
+namespace PhysicsBucketBenchmark
+{
+	// Returns the average nanoseconds per call of the passed in function over the set number of iterations
+	template<typename FunctionType>
+	double MeasureNsPerOp(int32 NumIterations, FunctionType&& Function)
+	{
+		const double StartTime = FPlatformTime::Seconds();
+		for (int32 i = 0; i < NumIterations; ++i)
+		{
+			Function();
+		}
+
+		return (FPlatformTime::Seconds() - StartTime) * 1.0e9 / FMath::Max(NumIterations, 1);
+	}
+
+	static void RunDispatchBenchmark(const TArray<FString>& Args)
+	{
+		const int32 NumIterations = Args.Num() > 0 ? FMath::Max(FCString::Atoi(*Args[0]), 1) : 1000000;
+
+		UPhysicsBucketBenchmarkTarget* Target = NewObject<UPhysicsBucketBenchmarkTarget>();
+		FGCObjectScopeGuard TargetGuard(Target);
+
+		const FName CallbackName = GET_FUNCTION_NAME_CHECKED(UPhysicsBucketBenchmarkTarget, BenchmarkCallback);
+		const FName EventName = GET_FUNCTION_NAME_CHECKED(UPhysicsBucketBenchmarkTarget, BenchmarkEvent);
+
+		// Per invoke cost of each way a bucket entry can be bound
+		FUpdatePhysicsBucketDrop ReflectedDrop(Target, CallbackName);
+
+		FDynamicPhysicsBucketUpdateTickSignature DynamicEvent;
+		DynamicEvent.BindUFunction(Target, EventName);
+		FUpdatePhysicsBucketDrop DynamicDrop(DynamicEvent);
+
+		FUpdatePhysicsBucketDrop TypedDrop;
+		TypedDrop.NativeCallback.BindUObject(Target, &UPhysicsBucketBenchmarkTarget::BenchmarkCallback);
+
+		FUpdatePhysicsBucketDrop LambdaDrop;
+		LambdaDrop.NativeCallback.BindWeakLambda(Target, [Target]() { return Target->BenchmarkCallback(); });
+
+		const double ReflectedNs = MeasureNsPerOp(NumIterations, [&ReflectedDrop]() { ReflectedDrop.ExecuteBoundCallback(); });
+		const double DynamicNs = MeasureNsPerOp(NumIterations, [&DynamicDrop]() { DynamicDrop.ExecuteBoundCallback(); });
+		const double TypedNs = MeasureNsPerOp(NumIterations, [&TypedDrop]() { TypedDrop.ExecuteBoundCallback(); });
+		const double LambdaNs = MeasureNsPerOp(NumIterations, [&LambdaDrop]() { LambdaDrop.ExecuteBoundCallback(); });
+
+		// Registration churn, the name based path pays for FindFunction on every add
+		FUpdatePhysicsBucketContainer Container;
+		const double NamedChurnNs = MeasureNsPerOp(NumIterations, [&Container, Target, CallbackName]()
+		{
+			Container.RemoveBucketEntry(Container.AddBucketObject(30, Target, CallbackName));
+		});
+
+		const double TypedChurnNs = MeasureNsPerOp(NumIterations, [&Container, Target]()
+		{
+			Container.RemoveBucketEntry(Container.AddReplicatingObject(30, Target, &UPhysicsBucketBenchmarkTarget::BenchmarkCallback));
+		});
+
+		UE_LOG(LogReplicatedPhysics, Display, TEXT("Bucket dispatch benchmark (%d iterations)"), NumIterations);
+		UE_LOG(LogReplicatedPhysics, Display, TEXT("  Invoke UFunction (BindUFunction): %.2f ns"), ReflectedNs);
+		UE_LOG(LogReplicatedPhysics, Display, TEXT("  Invoke dynamic delegate:          %.2f ns"), DynamicNs);
+		UE_LOG(LogReplicatedPhysics, Display, TEXT("  Invoke typed member function:     %.2f ns"), TypedNs);
+		UE_LOG(LogReplicatedPhysics, Display, TEXT("  Invoke weak lambda:               %.2f ns"), LambdaNs);
+		UE_LOG(LogReplicatedPhysics, Display, TEXT("  Add/remove by function name:      %.2f ns"), NamedChurnNs);
+		UE_LOG(LogReplicatedPhysics, Display, TEXT("  Add/remove typed by handle:       %.2f ns"), TypedChurnNs);
+	}
+
+#if WITH_DEV_AUTOMATION_TESTS
+	// Rates the container benchmark spreads its entries over, a mix of what client auth polls and gameplay code use
+	static const uint32 ContainerBenchmarkRates[] = { 10, 20, 30, 60, 100 };
+
+	static void AddContainerResult(FString& Csv, int32 NumEntries, const TCHAR* Operation, int32 NumOps, double TotalSeconds)
+	{
+		const double NsPerOp = TotalSeconds * 1.0e9 / FMath::Max(NumOps, 1);
+		Csv += FString::Printf(TEXT("%d,%s,%d,%.3f,%.2f\n"), NumEntries, Operation, NumOps, TotalSeconds * 1000.0, NsPerOp);
+		UE_LOG(LogReplicatedPhysics, Display, TEXT("  %7d entries  %-16s %9.3f ms  %10.2f ns/op"), NumEntries, Operation, TotalSeconds * 1000.0, NsPerOp);
+	}
+
+	static void RunContainerBenchmarkForSize(FAutomationTestBase& Test, FString& Csv, int32 NumEntries, int32 NumFrames, EPhysicsBucketDispatchMode DispatchMode)
+	{
+		// Every entry gets its own object so that the object index is exercised the same way real actors do
+		TArray<UPhysicsBucketBenchmarkTarget*> Targets;
+		Targets.Reserve(NumEntries);
+		for (int32 i = 0; i < NumEntries; ++i)
+		{
+			UPhysicsBucketBenchmarkTarget* Target = NewObject<UPhysicsBucketBenchmarkTarget>();
+			Target->AddToRoot();
+			Targets.Add(Target);
+		}
+
+		FUpdatePhysicsBucketContainer Container;
+		Container.SetDispatchMode(DispatchMode);
+
+		TArray<FPhysicsBucketHandle> Handles;
+		Handles.Reserve(NumEntries);
+
+		double StartTime = FPlatformTime::Seconds();
+		for (int32 i = 0; i < NumEntries; ++i)
+		{
+			Handles.Add(Container.AddReplicatingObject(ContainerBenchmarkRates[i % UE_ARRAY_COUNT(ContainerBenchmarkRates)], Targets[i], &UPhysicsBucketBenchmarkTarget::BenchmarkCallback));
+		}
+		AddContainerResult(Csv, NumEntries, TEXT("Add"), NumEntries, FPlatformTime::Seconds() - StartTime);
+
+		// Look up every object twice, front to back and back to front so the pattern isn't purely sequential
+		int32 NumFound = 0;
+		StartTime = FPlatformTime::Seconds();
+		for (int32 i = 0; i < NumEntries; ++i)
+		{
+			NumFound += Container.IsObjectInBucket(Targets[i]) ? 1 : 0;
+			NumFound += Container.IsObjectInBucket(Targets[NumEntries - 1 - i]) ? 1 : 0;
+		}
+		AddContainerResult(Csv, NumEntries, TEXT("IsObjectInBucket"), NumEntries * 2, FPlatformTime::Seconds() - StartTime);
+		Test.TestEqual(FString::Printf(TEXT("%d entries found"), NumEntries), NumFound, NumEntries * 2);
+
+		// Fixed 60Hz frames, the per op cost is per frame so it includes every fire of that frame
+		StartTime = FPlatformTime::Seconds();
+		int32 NumFires = 0;
+		for (int32 Frame = 0; Frame < NumFrames; ++Frame)
+		{
+			Container.UpdateBuckets(1.0f / 60.0f);
+			NumFires += Container.LastFrameStats.NumFires;
+		}
+		const double UpdateSeconds = FPlatformTime::Seconds() - StartTime;
+		AddContainerResult(Csv, NumEntries, TEXT("UpdateBuckets"), NumFrames, UpdateSeconds);
+		AddContainerResult(Csv, NumEntries, TEXT("UpdateFire"), NumFires, UpdateSeconds);
+		Test.TestTrue(FString::Printf(TEXT("%d entries fired"), NumEntries), NumFires > 0);
+
+		// Steady state churn, a tenth of the entries leave and come back at a different rate every frame
+		const int32 NumChurnPerFrame = FMath::Max(NumEntries / 10, 1);
+		int32 ChurnCursor = 0;
+		StartTime = FPlatformTime::Seconds();
+		for (int32 Frame = 0; Frame < NumFrames; ++Frame)
+		{
+			for (int32 i = 0; i < NumChurnPerFrame; ++i)
+			{
+				const int32 EntryIndex = ChurnCursor++ % NumEntries;
+				Container.RemoveBucketEntry(Handles[EntryIndex]);
+				Handles[EntryIndex] = Container.AddReplicatingObject(ContainerBenchmarkRates[(EntryIndex + Frame + 1) % UE_ARRAY_COUNT(ContainerBenchmarkRates)], Targets[EntryIndex], &UPhysicsBucketBenchmarkTarget::BenchmarkCallback);
+			}
+
+			Container.UpdateBuckets(1.0f / 60.0f);
+		}
+		AddContainerResult(Csv, NumEntries, TEXT("Churn"), NumChurnPerFrame * NumFrames, FPlatformTime::Seconds() - StartTime);
+
+		StartTime = FPlatformTime::Seconds();
+		for (const FPhysicsBucketHandle& Handle : Handles)
+		{
+			Container.RemoveBucketEntry(Handle);
+		}
+		AddContainerResult(Csv, NumEntries, TEXT("Remove"), NumEntries, FPlatformTime::Seconds() - StartTime);
+		Test.TestEqual(FString::Printf(TEXT("%d entries registered after removal"), NumEntries), Container.NumRegisteredEntries, 0);
+
+		// One shot timers spread over the first minute, armed and cancelled the way ping based timeouts are
+		FRandomStream TimerStream(NumEntries);
+		StartTime = FPlatformTime::Seconds();
+		for (int32 i = 0; i < NumEntries; ++i)
+		{
+			Handles[i] = Container.AddOneShotTimer(TimerStream.FRandRange(0.0f, 60.0f), Targets[i], &UPhysicsBucketBenchmarkTarget::BenchmarkEvent);
+		}
+		AddContainerResult(Csv, NumEntries, TEXT("TimerAdd"), NumEntries, FPlatformTime::Seconds() - StartTime);
+
+		StartTime = FPlatformTime::Seconds();
+		for (int32 Frame = 0; Frame < NumFrames; ++Frame)
+		{
+			Container.UpdateBuckets(1.0f / 60.0f);
+		}
+		AddContainerResult(Csv, NumEntries, TEXT("TimerUpdate"), NumFrames, FPlatformTime::Seconds() - StartTime);
+
+		StartTime = FPlatformTime::Seconds();
+		for (const FPhysicsBucketHandle& Handle : Handles)
+		{
+			Container.RemoveBucketEntry(Handle);
+		}
+		AddContainerResult(Csv, NumEntries, TEXT("TimerCancel"), NumEntries, FPlatformTime::Seconds() - StartTime);
+		Test.TestEqual(FString::Printf(TEXT("%d timers registered after cancelling"), NumEntries), Container.NumRegisteredEntries, 0);
+
+		for (UPhysicsBucketBenchmarkTarget* Target : Targets)
+		{
+			Target->RemoveFromRoot();
+		}
+	}
+
+	static void WriteContainerCsv(const FString& Csv, const TCHAR* DispatchModeName)
+	{
+		const FString CsvPath = FPaths::Combine(FPaths::ProfilingDir(), TEXT("ReplicatedPhysics"), FString::Printf(TEXT("BucketContainer-%s-%s.csv"), DispatchModeName, *FDateTime::Now().ToString()));
+		IFileManager::Get().MakeDirectory(*FPaths::GetPath(CsvPath), true);
+		if (FFileHelper::SaveStringToFile(Csv, *CsvPath))
+		{
+			UE_LOG(LogReplicatedPhysics, Display, TEXT("Wrote %s"), *CsvPath);
+		}
+		else
+		{
+			UE_LOG(LogReplicatedPhysics, Warning, TEXT("Failed to write %s"), *CsvPath);
+		}
+	}
+#endif // WITH_DEV_AUTOMATION_TESTS
+}
+
+#if WITH_DEV_AUTOMATION_TESTS
+// Runs headless, e.g. UnrealEditor-Cmd <Project> -nullrhi -unattended -ExecCmds="Automation RunTests ReplicatedPhysics.Bench.Container;Quit"
+// Drives the container with 1k, 10k and 100k entries at mixed rates in both dispatch modes and writes the timings to Saved/Profiling/ReplicatedPhysics
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FPhysicsBucketContainerBenchmarkTest, "ReplicatedPhysics.Bench.Container",
+	EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+
+bool FPhysicsBucketContainerBenchmarkTest::RunTest(const FString& Parameters)
+{
+	using namespace PhysicsBucketBenchmark;
+
+	constexpr int32 NumFrames = 120;
+
+	for (const EPhysicsBucketDispatchMode DispatchMode : { EPhysicsBucketDispatchMode::Batched, EPhysicsBucketDispatchMode::Staggered })
+	{
+		const TCHAR* DispatchModeName = DispatchMode == EPhysicsBucketDispatchMode::Staggered ? TEXT("Staggered") : TEXT("Batched");
+
+		FString Csv = TEXT("Entries,Operation,Ops,TotalMs,NsPerOp\n");
+		UE_LOG(LogReplicatedPhysics, Display, TEXT("Bucket container benchmark (%d frames, %s)"), NumFrames, DispatchModeName);
+
+		for (const int32 NumEntries : { 1000, 10000, 100000 })
+		{
+			RunContainerBenchmarkForSize(*this, Csv, NumEntries, NumFrames, DispatchMode);
+		}
+
+		WriteContainerCsv(Csv, DispatchModeName);
+	}
+
+	return true;
+}
+#endif // WITH_DEV_AUTOMATION_TESTS
+
+static FAutoConsoleCommand CmdPhysicsBucketDispatchBenchmark(
+	TEXT("ReplicatedPhysics.Bench.Dispatch"),
+	TEXT("Measures the per invoke cost of reflected, dynamic and typed bucket callbacks. Usage: ReplicatedPhysics.Bench.Dispatch [Iterations]"),
+	FConsoleCommandWithArgsDelegate::CreateStatic(&PhysicsBucketBenchmark::RunDispatchBenchmark));
+
+#endif // !UE_BUILD_SHIPPING
@@ -0,0 +1,30 @@
+// Copyright Hitbox Games, LLC. All Rights Reserved.
+
+#pragma once
+
+#include "UObject/Object.h"
+
+#include "PhysicsBucketBenchmarkTarget.generated.h"
+
+// Minimal bucket callback target used by the ReplicatedPhysics.Bench console commands
+UCLASS(Transient)
+class UPhysicsBucketBenchmarkTarget : public UObject
+{
+	GENERATED_BODY()
+
+public:
+	UFUNCTION()
+	bool BenchmarkCallback()
+	{
+		++NumCalls;
+		return true;
+	}
+
+	UFUNCTION()
+	void BenchmarkEvent()
+	{
+		++NumCalls;
+	}
+
+	int32 NumCalls = 0;
+};
@@ -2,14 +2,260 @@
 
 #include "PhysicsBucketUpdateSubsystem.h"
 
+#include "IReplicatedPhysicsModule.h"
+#include "Async/ParallelFor.h"
+#include "Components/PrimitiveComponent.h"
+#include "Engine/NetDriver.h"
+#include "Engine/World.h"
+#include "Physics/Experimental/PhysScene_Chaos.h"
+#include "ProfilingDebugging/CpuProfilerTrace.h"
+#include "UObject/UObjectGlobals.h"
+#include "ReplicatedPhysicsStats.h"
+
 #include UE_INLINE_GENERATED_CPP_BY_NAME(PhysicsBucketUpdateSubsystem)
 
+DECLARE_CYCLE_STAT(TEXT("Update Buckets"), STAT_PhysicsBucketUpdate, STATGROUP_ReplicatedPhysics);
+DECLARE_CYCLE_STAT(TEXT("Gather Stage"), STAT_PhysicsBucketGather, STATGROUP_ReplicatedPhysics);
+DECLARE_CYCLE_STAT(TEXT("Commit Stage"), STAT_PhysicsBucketCommit, STATGROUP_ReplicatedPhysics);
+DECLARE_CYCLE_STAT(TEXT("Purge Dead Entries"), STAT_PhysicsBucketPurge, STATGROUP_ReplicatedPhysics);
+DECLARE_CYCLE_STAT(TEXT("Pre Physics Apply"), STAT_PhysicsBucketPrePhysicsApply, STATGROUP_ReplicatedPhysics);
+DECLARE_CYCLE_STAT(TEXT("Physics State Gather"), STAT_PhysicsStateGather, STATGROUP_ReplicatedPhysics);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Buckets"), STAT_PhysicsBucketNumBuckets, STATGROUP_ReplicatedPhysics);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Live Callbacks"), STAT_PhysicsBucketLiveCallbacks, STATGROUP_ReplicatedPhysics);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Callback Fires"), STAT_PhysicsBucketFires, STATGROUP_ReplicatedPhysics);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Callback Removals"), STAT_PhysicsBucketRemovals, STATGROUP_ReplicatedPhysics);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Bucket Overruns"), STAT_PhysicsBucketOverruns, STATGROUP_ReplicatedPhysics);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Deferred Callbacks"), STAT_PhysicsBucketDeferred, STATGROUP_ReplicatedPhysics);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Callbacks Purged By GC"), STAT_PhysicsBucketPurged, STATGROUP_ReplicatedPhysics);
+DECLARE_FLOAT_ACCUMULATOR_STAT(TEXT("Max Lateness (ms)"), STAT_PhysicsBucketMaxLateness, STATGROUP_ReplicatedPhysics);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Gathered Bodies"), STAT_PhysicsStateGatherBodies, STATGROUP_ReplicatedPhysics);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Changed Bodies"), STAT_PhysicsStateGatherChanged, STATGROUP_ReplicatedPhysics);
+
+static int32 GPhysicsBucketDispatchMode = 0;
+static FAutoConsoleVariableRef CVarPhysicsBucketDispatchMode(
+	TEXT("ReplicatedPhysics.Buckets.DispatchMode"),
+	GPhysicsBucketDispatchMode,
+	TEXT("Default dispatch mode of the physics bucket subsystem. 0 = Batched (all entries fire together), 1 = Staggered (entries are spread across the frames of their period)"),
+	ECVF_Default);
+
+static float GPhysicsBucketTickRate = 120.0f;
+static FAutoConsoleVariableRef CVarPhysicsBucketTickRate(
+	TEXT("ReplicatedPhysics.Buckets.TickRate"),
+	GPhysicsBucketTickRate,
+	TEXT("Resolution of the bucket timing wheel in ticks per second. Rates are snapped to a whole number of ticks and staggered buckets get one phase per tick of their period. Read when the subsystem is created"),
+	ECVF_Default);
+
+static bool GPhysicsBucketAlignToNetTick = false;
+static FAutoConsoleVariableRef CVarPhysicsBucketAlignToNetTick(
+	TEXT("ReplicatedPhysics.Buckets.AlignToNetTick"),
+	GPhysicsBucketAlignToNetTick,
+	TEXT("If true the physics bucket subsystem fires from the world's post actor tick, ahead of the NetDriver tick flush, so client auth RPCs leave in that frame's outgoing packet"),
+	ECVF_Default);
+
+static bool GPhysicsBucketParallelGather = true;
+static FAutoConsoleVariableRef CVarPhysicsBucketParallelGather(
+	TEXT("ReplicatedPhysics.Buckets.ParallelGather"),
+	GPhysicsBucketParallelGather,
+	TEXT("If true the gather stage of two phase bucket entries runs across worker threads"),
+	ECVF_Default);
+
+static int32 GPhysicsBucketParallelGatherMinBatch = 32;
+static FAutoConsoleVariableRef CVarPhysicsBucketParallelGatherMinBatch(
+	TEXT("ReplicatedPhysics.Buckets.ParallelGatherMinBatch"),
+	GPhysicsBucketParallelGatherMinBatch,
+	TEXT("Minimum number of entries firing in a phase before the gather stage is spread across worker threads"),
+	ECVF_Default);
+
+static float GPhysicsBucketFrameBudgetMs = 0.0f;
+static FAutoConsoleVariableRef CVarPhysicsBucketFrameBudgetMs(
+	TEXT("ReplicatedPhysics.Buckets.FrameBudgetMs"),
+	GPhysicsBucketFrameBudgetMs,
+	TEXT("Default time budget in milliseconds for a single bucket update, due entries past the budget are carried over to the next update. 0 = unlimited"),
+	ECVF_Default);
+
+static int32 GPhysicsBucketMaxCallbacksPerFrame = 0;
+static FAutoConsoleVariableRef CVarPhysicsBucketMaxCallbacksPerFrame(
+	TEXT("ReplicatedPhysics.Buckets.MaxCallbacksPerFrame"),
+	GPhysicsBucketMaxCallbacksPerFrame,
+	TEXT("Default maximum number of callbacks fired by a single bucket update, due entries past the limit are carried over to the next update. 0 = unlimited"),
+	ECVF_Default);
+
+static bool GPhysicsBucketPurgeOnGC = true;
+static FAutoConsoleVariableRef CVarPhysicsBucketPurgeOnGC(
+	TEXT("ReplicatedPhysics.Buckets.PurgeOnGC"),
+	GPhysicsBucketPurgeOnGC,
+	TEXT("If true the entries of garbage collected objects are purged right after every GC instead of when their bucket next fires"),
+	ECVF_Default);
+
+static int32 GPhysicsBucketMaxStaggerPhases = 32;
+static FAutoConsoleVariableRef CVarPhysicsBucketMaxStaggerPhases(
+	TEXT("ReplicatedPhysics.Buckets.MaxStaggerPhases"),
+	GPhysicsBucketMaxStaggerPhases,
+	TEXT("Maximum number of phases that a staggered bucket is sliced into"),
+	ECVF_Default);
+
+void UPhysicsBucketUpdateSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	BucketContainer.SetTickRate(GPhysicsBucketTickRate);
+	BucketContainer.SetDispatchMode(GPhysicsBucketDispatchMode == 1 ? EPhysicsBucketDispatchMode::Staggered : EPhysicsBucketDispatchMode::Batched);
+	BucketContainer.SetFrameBudget(GPhysicsBucketFrameBudgetMs, GPhysicsBucketMaxCallbacksPerFrame);
+	bAlignToNetTick = GPhysicsBucketAlignToNetTick;
+
+	PostGarbageCollectHandle = FCoreUObjectDelegates::GetPostGarbageCollect().AddUObject(this, &ThisClass::OnPostGarbageCollect);
+}
+
+void UPhysicsBucketUpdateSubsystem::Deinitialize()
+{
+	UnbindNetTick();
+
+	FCoreUObjectDelegates::GetPostGarbageCollect().Remove(PostGarbageCollectHandle);
+	PostGarbageCollectHandle.Reset();
+
+	if (PhysScenePreTickHandle.IsValid())
+	{
+		if (FPhysScene_Chaos* PhysScene = GetWorld()->GetPhysicsScene())
+		{
+			PhysScene->OnPhysScenePreTick.Remove(PhysScenePreTickHandle);
+		}
+
+		PhysScenePreTickHandle.Reset();
+	}
+
+	PendingPrePhysicsApplies.Reset();
+	FlushingPrePhysicsApplies.Reset();
+
+	Super::Deinitialize();
+}
+
+void UPhysicsBucketUpdateSubsystem::OnWorldBeginPlay(UWorld& InWorld)
+{
+	Super::OnWorldBeginPlay(InWorld);
+
+	if (bAlignToNetTick)
+	{
+		BindNetTick();
+	}
+
+	if (FPhysScene_Chaos* PhysScene = InWorld.GetPhysicsScene())
+	{
+		PhysScenePreTickHandle = PhysScene->OnPhysScenePreTick.AddUObject(this, &ThisClass::OnPhysScenePreTick);
+	}
+}
+
+void UPhysicsBucketUpdateSubsystem::SetAlignToNetTick(bool bNewAlignToNetTick)
+{
+	bAlignToNetTick = bNewAlignToNetTick;
+
+	if (bAlignToNetTick)
+	{
+		BindNetTick();
+	}
+	else
+	{
+		UnbindNetTick();
+	}
+}
+
+bool UPhysicsBucketUpdateSubsystem::IsAlignedToNetTick() const
+{
+	return NetTickHandle.IsValid();
+}
+
+void UPhysicsBucketUpdateSubsystem::BindNetTick()
+{
+	UnbindNetTick();
+
+	UWorld* World = GetWorld();
+	if (!World || !World->GetNetDriver())
+		return;
+
+	// UWorld::Tick broadcasts the post actor tick before it broadcasts the tick flush, so we are ahead of every
+	// driver's flush by construction rather than by the order that delegates were bound in
+	NetTickHandle = FWorldDelegates::OnWorldPostActorTick.AddUObject(this, &ThisClass::OnWorldPostActorTick);
+}
+
+void UPhysicsBucketUpdateSubsystem::UnbindNetTick()
+{
+	if (NetTickHandle.IsValid())
+	{
+		FWorldDelegates::OnWorldPostActorTick.Remove(NetTickHandle);
+		NetTickHandle.Reset();
+	}
+}
+
+void UPhysicsBucketUpdateSubsystem::OnWorldPostActorTick(UWorld* InWorld, ELevelTick TickType, float DeltaSeconds)
+{
+	// Broadcast for every world
+	UWorld* World = GetWorld();
+	if (InWorld != World)
+		return;
+
+	if (!World->GetNetDriver())
+	{
+		// The driver went away, drop back to the tickable object tick
+		UnbindNetTick();
+		return;
+	}
+
+	if (BucketContainer.bNeedsUpdate)
+	{
+		DispatchBuckets(DeltaSeconds);
+	}
+}
+
+void UPhysicsBucketUpdateSubsystem::OnPostGarbageCollect()
+{
+	if (GPhysicsBucketPurgeOnGC && BucketContainer.NumRegisteredEntries > 0)
+	{
+		PurgeDeadEntries();
+	}
+}
+
+int32 UPhysicsBucketUpdateSubsystem::PurgeDeadEntries()
+{
+	const int32 NumPurged = BucketContainer.PurgeDeadEntries();
+	UE_CLOG(NumPurged > 0, LogReplicatedPhysics, Verbose, TEXT("Purged %d bucket entries of garbage collected objects"), NumPurged);
+	return NumPurged;
+}
+
 bool UPhysicsBucketUpdateSubsystem::AddObjectToBucket(int32 UpdateHTZ, UObject* InObject, FName FunctionName)
 {
 	if (!InObject || UpdateHTZ < 1)
 		return false;
 
-	return BucketContainer.AddBucketObject(UpdateHTZ, InObject, FunctionName);
+	return BucketContainer.AddBucketObject(UpdateHTZ, InObject, FunctionName).IsValid();
+}
+
+FPhysicsBucketHandle UPhysicsBucketUpdateSubsystem::AddObjectToBucketWithHandle(int32 UpdateHTZ, UObject* InObject, FName FunctionName, float Priority)
+{
+	if (!InObject || UpdateHTZ < 1)
+		return FPhysicsBucketHandle();
+
+	return BucketContainer.AddBucketObject(UpdateHTZ, InObject, FunctionName, Priority);
+}
+
+bool UPhysicsBucketUpdateSubsystem::RemoveBucketEntry(FPhysicsBucketHandle& Handle)
+{
+	const bool bRemoved = BucketContainer.RemoveBucketEntry(Handle);
+	Handle.Invalidate();
+	return bRemoved;
+}
+
+bool UPhysicsBucketUpdateSubsystem::IsBucketEntryRegistered(const FPhysicsBucketHandle& Handle) const
+{
+	return BucketContainer.IsBucketEntryRegistered(Handle);
+}
+
+bool UPhysicsBucketUpdateSubsystem::SetBucketEntryPriority(const FPhysicsBucketHandle& Handle, float NewPriority)
+{
+	return BucketContainer.SetBucketEntryPriority(Handle, NewPriority);
+}
+
+float UPhysicsBucketUpdateSubsystem::GetBucketEntryLateness(const FPhysicsBucketHandle& Handle) const
+{
+	return BucketContainer.GetBucketEntryLateness(Handle);
 }
 
 bool UPhysicsBucketUpdateSubsystem::K2_AddObjectToBucket(int32 UpdateHTZ, UObject* InObject, FName FunctionName)
@@ -17,7 +263,7 @@ bool UPhysicsBucketUpdateSubsystem::K2_AddObjectToBucket(int32 UpdateHTZ, UObjec
 	if (!InObject || UpdateHTZ < 1)
 		return false;
 
-	return BucketContainer.AddBucketObject(UpdateHTZ, InObject, FunctionName);
+	return BucketContainer.AddBucketObject(UpdateHTZ, InObject, FunctionName).IsValid();
 }
 
 
@@ -26,7 +272,7 @@ bool UPhysicsBucketUpdateSubsystem::K2_AddObjectEventToBucket(FDynamicPhysicsBuc
 	if (!Delegate.IsBound())
 		return false;
 
-	return BucketContainer.AddBucketObject(UpdateHTZ, Delegate);
+	return BucketContainer.AddBucketObject(UpdateHTZ, Delegate).IsValid();
 }
 
 bool UPhysicsBucketUpdateSubsystem::RemoveObjectFromBucketByFunctionName(UObject* InObject, FName FunctionName)
@@ -66,334 +312,1428 @@ bool UPhysicsBucketUpdateSubsystem::IsActive()
 	return BucketContainer.bNeedsUpdate;
 }
 
-void UPhysicsBucketUpdateSubsystem::Tick(float DeltaTime)
+void UPhysicsBucketUpdateSubsystem::SetDispatchMode(EPhysicsBucketDispatchMode NewDispatchMode)
 {
-	BucketContainer.UpdateBuckets(DeltaTime);
+	BucketContainer.SetDispatchMode(NewDispatchMode);
 }
 
-bool UPhysicsBucketUpdateSubsystem::IsTickable() const
+EPhysicsBucketDispatchMode UPhysicsBucketUpdateSubsystem::GetDispatchMode() const
 {
-	return BucketContainer.bNeedsUpdate;
+	return BucketContainer.DispatchMode;
 }
 
-UWorld* UPhysicsBucketUpdateSubsystem::GetTickableGameObjectWorld() const
+void UPhysicsBucketUpdateSubsystem::SetFrameBudget(float BudgetMs, int32 MaxCallbacks)
 {
-	return GetWorld();
+	BucketContainer.SetFrameBudget(BudgetMs, MaxCallbacks);
 }
 
-bool UPhysicsBucketUpdateSubsystem::IsTickableInEditor() const
+void UPhysicsBucketUpdateSubsystem::Tick(float DeltaTime)
 {
-	return false;
-}
+	// A NetDriver showed up after begin play, move over to its tick for the following frames
+	if (bAlignToNetTick && !NetTickHandle.IsValid() && GetWorld()->GetNetDriver())
+	{
+		BindNetTick();
+	}
 
-bool UPhysicsBucketUpdateSubsystem::IsTickableWhenPaused() const
-{
-	return false;
+	// We may only be ticking for the pre physics fallback below
+	if (!NetTickHandle.IsValid())
+	{
+		DispatchBuckets(DeltaTime);
+	}
+
+	// Without a physics scene there is no step to line up with, apply once per frame instead
+	if (!PhysScenePreTickHandle.IsValid())
+	{
+		FlushPrePhysicsApplies();
+	}
 }
 
-ETickableTickType UPhysicsBucketUpdateSubsystem::GetTickableTickType() const
+void UPhysicsBucketUpdateSubsystem::DispatchBuckets(float DeltaTime)
 {
-	if (IsTemplate(RF_ClassDefaultObject))
-		return ETickableTickType::Never;
+	// Gather stages can run across workers, so they read the bodies from a snapshot taken here on the game thread
+	// Later requests in the frame, like the server's PreReplication, reuse the same pass
+	if (BucketContainer.NumGatherEntries > 0 && PhysicsStateGather.NumRegistered > 0)
+	{
+		GatherPhysicsStatesIfNeeded();
+	}
 
-	return ETickableTickType::Conditional;
+	BucketContainer.UpdateBuckets(DeltaTime);
+	OnBucketsDispatched.Broadcast();
 }
 
-TStatId UPhysicsBucketUpdateSubsystem::GetStatId() const
+void UPhysicsBucketUpdateSubsystem::OnPhysScenePreTick(FPhysScene_Chaos* PhysScene, float DeltaSeconds)
 {
-	RETURN_QUICK_DECLARE_CYCLE_STAT(UVRGripScriptBase, STATGROUP_Tickables);
+	FlushPrePhysicsApplies();
 }
 
-bool FUpdatePhysicsBucketDrop::ExecuteBoundCallback()
+void UPhysicsBucketUpdateSubsystem::FlushPrePhysicsApplies()
 {
-	if (NativeCallback.IsBound())
-	{
-		return NativeCallback.Execute();
-	}
-	else if (DynamicCallback.IsBound())
+	if (PendingPrePhysicsApplies.IsEmpty())
+		return;
+
+	SCOPE_CYCLE_COUNTER(STAT_PhysicsBucketPrePhysicsApply);
+	TRACE_CPUPROFILER_EVENT_SCOPE(UPhysicsBucketUpdateSubsystem::FlushPrePhysicsApplies);
+
+	// Applies can queue again for the following step, so run from the other buffer, both keep their allocations between steps
+	Swap(PendingPrePhysicsApplies, FlushingPrePhysicsApplies);
+
+	for (TPair<FObjectKey, FSimpleDelegate>& Apply : FlushingPrePhysicsApplies)
 	{
-		DynamicCallback.Execute();
-		return true;
+		Apply.Value.ExecuteIfBound();
 	}
 
-	return false;
+	FlushingPrePhysicsApplies.Reset();
 }
 
-bool FUpdatePhysicsBucketDrop::IsBoundToObjectFunction(UObject* Obj, FName& FuncName)
+int32 UPhysicsBucketUpdateSubsystem::RegisterPhysicsStateGather(UPrimitiveComponent* Component, float LocationThreshold, float RotationThreshold, float VelocityThreshold)
 {
-	return (NativeCallback.IsBoundToObject(Obj) && FunctionName == FuncName);
-}
+	if (!Component)
+		return INDEX_NONE;
 
-bool FUpdatePhysicsBucketDrop::IsBoundToObjectDelegate(FDynamicPhysicsBucketUpdateTickSignature& DynEvent)
-{
-	return DynamicCallback == DynEvent;
+	return PhysicsStateGather.AddSlot(Component, LocationThreshold, RotationThreshold, VelocityThreshold);
 }
 
-bool FUpdatePhysicsBucketDrop::IsBoundToObject(UObject* Obj)
+void UPhysicsBucketUpdateSubsystem::UnregisterPhysicsStateGather(int32& Slot)
 {
-	return (NativeCallback.IsBoundToObject(Obj) || DynamicCallback.IsBoundToObject(Obj));
+	PhysicsStateGather.RemoveSlot(Slot);
+	Slot = INDEX_NONE;
 }
 
-FUpdatePhysicsBucketDrop::FUpdatePhysicsBucketDrop()
+bool UPhysicsBucketUpdateSubsystem::GetGatheredPhysicsState(int32 Slot, const UPrimitiveComponent* Component, FGatheredPhysicsState& OutState)
 {
-	FunctionName = NAME_None;
-}
+	if (!PhysicsStateGather.Flags.IsValidIndex(Slot) || !Component)
+		return false;
 
-FUpdatePhysicsBucketDrop::FUpdatePhysicsBucketDrop(FDynamicPhysicsBucketUpdateTickSignature& DynCallback)
-{
-	DynamicCallback = DynCallback;
-}
+	GatherPhysicsStatesIfNeeded();
 
-FUpdatePhysicsBucketDrop::FUpdatePhysicsBucketDrop(UObject* Obj, FName FuncName)
-{
-	if (Obj && Obj->FindFunction(FuncName))
-	{
-		FunctionName = FuncName;
-		NativeCallback.BindUFunction(Obj, FunctionName);
-	}
-	else
-	{
-		FunctionName = NAME_None;
-	}
+	const uint8 SlotFlags = PhysicsStateGather.Flags[Slot];
+	if (!(SlotFlags & FPhysicsStateGatherBuffer::Valid) || PhysicsStateGather.Components[Slot].Get() != Component)
+		return false;
+
+	PhysicsStateGather.GetState(Slot, OutState);
+	return true;
 }
 
-bool FUpdatePhysicsBucket::Update(float DeltaTime)
+bool UPhysicsBucketUpdateSubsystem::PeekGatheredPhysicsState(int32 Slot, FGatheredPhysicsState& OutState) const
 {
-	//#TODO: Need to consider batching / spreading out load if there are a lot of updating objects in the bucket
-	if (Callbacks.Num() < 1)
+	if (!PhysicsStateGather.Flags.IsValidIndex(Slot) || PhysicsStateGather.LastGatherFrame != GFrameCounter)
 		return false;
 
-	// Check for if this bucket is ready to fire events
-	nUpdateCount += DeltaTime;
-	if (nUpdateCount >= nUpdateRate)
-	{
-		nUpdateCount = 0.0f;
-		for (int i = Callbacks.Num() - 1; i >= 0; --i)
-		{
-			if (Callbacks[i].ExecuteBoundCallback())
-			{
-				// If this returns true then we keep it in the queue
-				continue;
-			}
-
-			// Remove the callback, it is complete or invalid
-			Callbacks.RemoveAt(i);
-		}
-	}
+	if (!(PhysicsStateGather.Flags[Slot] & FPhysicsStateGatherBuffer::Valid))
+		return false;
 
-	return Callbacks.Num() > 0;
+	PhysicsStateGather.GetState(Slot, OutState);
+	return true;
 }
 
-void FUpdatePhysicsBucketContainer::UpdateBuckets(float DeltaTime)
+void UPhysicsBucketUpdateSubsystem::MarkGatheredPhysicsStateSent(int32 Slot)
 {
-	TArray<uint32> BucketsToRemove;
-	for (auto& Bucket : ReplicationBuckets)
+	if (PhysicsStateGather.Flags.IsValidIndex(Slot))
 	{
-		if (!Bucket.Value.Update(DeltaTime))
-		{
-			// Add Bucket to list to remove at end of update
-			BucketsToRemove.Add(Bucket.Key);
-		}
+		PhysicsStateGather.MarkSent(Slot);
 	}
+}
 
-	// Remove unused buckets so that they don't get ticked
-	for (const uint32 Key : BucketsToRemove)
-	{
-		ReplicationBuckets.Remove(Key);
-	}
+void UPhysicsBucketUpdateSubsystem::SetPhysicsStateGatherPaused(int32 Slot, bool bPaused)
+{
+	if (!PhysicsStateGather.Flags.IsValidIndex(Slot) || !(PhysicsStateGather.Flags[Slot] & FPhysicsStateGatherBuffer::Registered))
+		return;
 
-	if (ReplicationBuckets.Num() < 1)
-		bNeedsUpdate = false;
+	uint8& SlotFlags = PhysicsStateGather.Flags[Slot];
+	SlotFlags = (uint8)(bPaused ? (SlotFlags | FPhysicsStateGatherBuffer::Paused) : (SlotFlags & ~FPhysicsStateGatherBuffer::Paused));
 }
 
-bool FUpdatePhysicsBucketContainer::AddBucketObject(uint32 UpdateHTZ, UObject* InObject, FName FunctionName)
+void UPhysicsBucketUpdateSubsystem::GatherPhysicsStatesIfNeeded()
 {
-	if (!InObject || InObject->FindFunction(FunctionName) == nullptr || UpdateHTZ < 1)
-		return false;
+	// Every PreReplication of the frame reads from the same pass
+	if (PhysicsStateGather.LastGatherFrame == GFrameCounter)
+		return;
 
-	// First verify that this object isn't already contained in a bucket, if it is then erase it so that we can replace it below
-	RemoveBucketObject(InObject, FunctionName);
+	PhysicsStateGather.LastGatherFrame = GFrameCounter;
 
-	if (ReplicationBuckets.Contains(UpdateHTZ))
-	{
-		ReplicationBuckets[UpdateHTZ].Callbacks.Add(FUpdatePhysicsBucketDrop(InObject, FunctionName));
-	}
-	else
-	{
-		FUpdatePhysicsBucket& newBucket = ReplicationBuckets.Add(UpdateHTZ, FUpdatePhysicsBucket(UpdateHTZ));
-		ReplicationBuckets[UpdateHTZ].Callbacks.Add(FUpdatePhysicsBucketDrop(InObject, FunctionName));
-	}
+	SCOPE_CYCLE_COUNTER(STAT_PhysicsStateGather);
+	TRACE_CPUPROFILER_EVENT_SCOPE(UPhysicsBucketUpdateSubsystem::GatherPhysicsStates);
 
-	if (ReplicationBuckets.Num() > 0)
-		bNeedsUpdate = true;
+	PhysicsStateGather.Gather(GetWorld());
+	PhysicsStateGather.DetectChanges();
 
-	return true;
+	SET_DWORD_STAT(STAT_PhysicsStateGatherBodies, PhysicsStateGather.NumRegistered);
+	SET_DWORD_STAT(STAT_PhysicsStateGatherChanged, PhysicsStateGather.NumChanged);
+	CSV_CUSTOM_STAT(ReplicatedPhysics, GatheredBodies, PhysicsStateGather.NumRegistered, ECsvCustomStatOp::Set);
+	CSV_CUSTOM_STAT(ReplicatedPhysics, ChangedBodies, PhysicsStateGather.NumChanged, ECsvCustomStatOp::Set);
 }
 
-
-bool FUpdatePhysicsBucketContainer::AddBucketObject(uint32 UpdateHTZ, FDynamicPhysicsBucketUpdateTickSignature& Delegate)
+int32 FPhysicsStateGatherBuffer::AddSlot(UPrimitiveComponent* Component, float LocationThreshold, float RotationThreshold, float VelocityThreshold)
 {
-	if (!Delegate.IsBound() || UpdateHTZ < 1)
-		return false;
-
-	// First verify that this object isn't already contained in a bucket, if it is then erase it so that we can replace it below
-	RemoveBucketObject(Delegate);
-
-	if (ReplicationBuckets.Contains(UpdateHTZ))
+	int32 Slot = INDEX_NONE;
+	if (FreeSlots.Num() > 0)
 	{
-		ReplicationBuckets[UpdateHTZ].Callbacks.Add(FUpdatePhysicsBucketDrop(Delegate));
+		Slot = FreeSlots.Pop(EAllowShrinking::No);
 	}
 	else
 	{
-		FUpdatePhysicsBucket& newBucket = ReplicationBuckets.Add(UpdateHTZ, FUpdatePhysicsBucket(UpdateHTZ));
-		ReplicationBuckets[UpdateHTZ].Callbacks.Add(FUpdatePhysicsBucketDrop(Delegate));
+		Slot = NumSlots++;
+
+		// Lanes always cover whole vectors, the padding slots stay zeroed and never register as changed
+		const int32 NumPaddedSlots = Align(NumSlots, LaneWidth);
+		for (int32 Lane = 0; Lane < NumLanes; ++Lane)
+		{
+			Current[Lane].SetNumZeroed(NumPaddedSlots);
+			Sent[Lane].SetNumZeroed(NumPaddedSlots);
+		}
+
+		LocationThresholdSq.SetNumZeroed(NumPaddedSlots);
+		VelocityThresholdSq.SetNumZeroed(NumPaddedSlots);
+		RotationThresholdCos.SetNumZeroed(NumPaddedSlots);
+		Components.SetNum(NumSlots);
+		PhysicsFrames.SetNumZeroed(NumSlots);
+		Flags.SetNumZeroed(NumSlots);
+	}
+
+	for (int32 Lane = 0; Lane < NumLanes; ++Lane)
+	{
+		Current[Lane][Slot] = 0.0;
+		Sent[Lane][Slot] = 0.0;
 	}
 
-	if (ReplicationBuckets.Num() > 0)
-		bNeedsUpdate = true;
+	LocationThresholdSq[Slot] = FMath::Square((double)LocationThreshold);
+	VelocityThresholdSq[Slot] = FMath::Square((double)VelocityThreshold);
+	RotationThresholdCos[Slot] = FMath::Cos(FMath::DegreesToRadians((double)RotationThreshold) * 0.5);
+	Components[Slot] = Component;
+	PhysicsFrames[Slot] = INDEX_NONE;
+	Flags[Slot] = Registered;
+	++NumRegistered;
 
-	return true;
+	return Slot;
 }
 
-bool FUpdatePhysicsBucketContainer::RemoveBucketObject(UObject* ObjectToRemove, FName FunctionName)
+void FPhysicsStateGatherBuffer::RemoveSlot(int32 Slot)
 {
-	if (!ObjectToRemove || ObjectToRemove->FindFunction(FunctionName) == nullptr)
-		return false;
+	if (!Flags.IsValidIndex(Slot) || !(Flags[Slot] & Registered))
+		return;
 
-	// Store if we ended up removing it
-	bool bRemovedObject = false;
+	Components[Slot] = nullptr;
+	Flags[Slot] = 0;
+	FreeSlots.Add(Slot);
+	--NumRegistered;
+}
 
-	TArray<uint32> BucketsToRemove;
-	for (auto& Bucket : ReplicationBuckets)
+void FPhysicsStateGatherBuffer::Gather(UWorld* World)
+{
+	FPhysScene_Chaos* Scene = World ? static_cast<FPhysScene_Chaos*>(World->GetPhysicsScene()) : nullptr;
+	const int32 SolverFrame = (Scene && Scene->GetSolver()) ? Scene->GetSolver()->GetCurrentFrame() : INDEX_NONE;
+	CacheFrame = Scene ? Scene->ReplicationCache.ServerFrame : 0;
+
+	for (int32 Slot = 0; Slot < NumSlots; ++Slot)
 	{
-		for (int i = Bucket.Value.Callbacks.Num() - 1; i >= 0; --i)
-		{
-			if (Bucket.Value.Callbacks[i].IsBoundToObjectFunction(ObjectToRemove, FunctionName))
-			{
-				Bucket.Value.Callbacks.RemoveAt(i);
-				bRemovedObject = true;
+		uint8& SlotFlags = Flags[Slot];
+		SlotFlags &= ~(Valid | Sleeping | FromCache | Changed);
 
-				// Leave the loop, this is called in add as well so we should never get duplicate entries
-				break;
-			}
-		}
+		if (!(SlotFlags & Registered) || (SlotFlags & Paused))
+			continue;
+
+		UPrimitiveComponent* Component = Components[Slot].Get();
+		if (!Component || !Component->IsSimulatingPhysics())
+			continue;
+
+		int ServerFrame = 0;
+		const FRigidBodyState* FoundState = Scene ? Scene->GetStateFromReplicationCache(Component, ServerFrame) : nullptr;
 
-		if (bRemovedObject)
+		// Fallback to GT data
+		FRigidBodyState GameThreadState;
+		if (FoundState)
 		{
-			break;
+			SlotFlags |= FromCache;
+			PhysicsFrames[Slot] = CacheFrame;
+		}
+		else
+		{
+			Component->GetRigidBodyState(GameThreadState);
+			FoundState = &GameThreadState;
+			PhysicsFrames[Slot] = SolverFrame;
 		}
-	}
 
-	return bRemovedObject;
+		Current[LocationX][Slot] = FoundState->Position.X;
+		Current[LocationY][Slot] = FoundState->Position.Y;
+		Current[LocationZ][Slot] = FoundState->Position.Z;
+		Current[RotationX][Slot] = FoundState->Quaternion.X;
+		Current[RotationY][Slot] = FoundState->Quaternion.Y;
+		Current[RotationZ][Slot] = FoundState->Quaternion.Z;
+		Current[RotationW][Slot] = FoundState->Quaternion.W;
+		Current[LinearVelocityX][Slot] = FoundState->LinVel.X;
+		Current[LinearVelocityY][Slot] = FoundState->LinVel.Y;
+		Current[LinearVelocityZ][Slot] = FoundState->LinVel.Z;
+		Current[AngularVelocityX][Slot] = FoundState->AngVel.X;
+		Current[AngularVelocityY][Slot] = FoundState->AngVel.Y;
+		Current[AngularVelocityZ][Slot] = FoundState->AngVel.Z;
+
+		SlotFlags |= Valid | ((FoundState->Flags & ERigidBodyFlags::Sleeping) ? Sleeping : 0);
+	}
 }
 
-bool FUpdatePhysicsBucketContainer::RemoveBucketObject(FDynamicPhysicsBucketUpdateTickSignature& DynEvent)
+namespace PhysicsStateGather
 {
-	if (!DynEvent.IsBound())
-		return false;
-
-	// Store if we ended up removing it
-	bool bRemovedObject = false;
+	static VectorRegister4Double LoadLane(const TArray<double>& Lane, int32 FirstSlot)
+	{
+		return VectorLoad(Lane.GetData() + FirstSlot);
+	}
 
-	TArray<uint32> BucketsToRemove;
-	for (auto& Bucket : ReplicationBuckets)
+	// Squared distance between the A and B vectors starting at FirstLane, for 4 slots at once
+	static VectorRegister4Double DistanceSquared(const TArray<double>* A, const TArray<double>* B, int32 FirstLane, int32 FirstSlot)
 	{
-		for (int i = Bucket.Value.Callbacks.Num() - 1; i >= 0; --i)
+		VectorRegister4Double Result = VectorZeroDouble();
+		for (int32 Axis = 0; Axis < 3; ++Axis)
 		{
-			if (Bucket.Value.Callbacks[i].IsBoundToObjectDelegate(DynEvent))
-			{
-				Bucket.Value.Callbacks.RemoveAt(i);
-				bRemovedObject = true;
-
-				// Leave the loop, this is called in add as well so we should never get duplicate entries
-				break;
-			}
+			const VectorRegister4Double Delta = VectorSubtract(LoadLane(A[FirstLane + Axis], FirstSlot), LoadLane(B[FirstLane + Axis], FirstSlot));
+			Result = VectorMultiplyAdd(Delta, Delta, Result);
 		}
 
-		if (bRemovedObject)
+		return Result;
+	}
+
+	static VectorRegister4Double Dot(const TArray<double>* A, const TArray<double>* B, int32 FirstLane, int32 NumAxes, int32 FirstSlot)
+	{
+		VectorRegister4Double Result = VectorZeroDouble();
+		for (int32 Axis = 0; Axis < NumAxes; ++Axis)
 		{
-			break;
+			Result = VectorMultiplyAdd(LoadLane(A[FirstLane + Axis], FirstSlot), LoadLane(B[FirstLane + Axis], FirstSlot), Result);
 		}
+
+		return Result;
 	}
 
-	return bRemovedObject;
+	// Set where exactly one of the two vectors is zero, a body coming to or leaving a stop always counts as a change
+	static VectorRegister4Double StoppedOrStarted(const TArray<double>* A, const TArray<double>* B, int32 FirstLane, int32 FirstSlot)
+	{
+		const VectorRegister4Double Zero = VectorZeroDouble();
+		return VectorBitwiseXor(VectorCompareEQ(Dot(A, A, FirstLane, 3, FirstSlot), Zero), VectorCompareEQ(Dot(B, B, FirstLane, 3, FirstSlot), Zero));
+	}
 }
 
-bool FUpdatePhysicsBucketContainer::RemoveObjectFromAllBuckets(UObject* ObjectToRemove)
+void FPhysicsStateGatherBuffer::DetectChanges()
 {
-	if (!ObjectToRemove)
-		return false;
+	using namespace PhysicsStateGather;
 
-	// Store if we ended up removing it
-	bool bRemovedObject = false;
-
-	TArray<uint32> BucketsToRemove;
-	for (auto& Bucket : ReplicationBuckets)
+	NumChanged = 0;
+	for (int32 FirstSlot = 0; FirstSlot < NumSlots; FirstSlot += LaneWidth)
 	{
-		for (int i = Bucket.Value.Callbacks.Num() - 1; i >= 0; --i)
+		const VectorRegister4Double VelocityThreshold = LoadLane(VelocityThresholdSq, FirstSlot);
+
+		VectorRegister4Double ChangedMask = VectorCompareGT(DistanceSquared(Current, Sent, LocationX, FirstSlot), LoadLane(LocationThresholdSq, FirstSlot));
+		ChangedMask = VectorBitwiseOr(ChangedMask, VectorCompareGT(DistanceSquared(Current, Sent, LinearVelocityX, FirstSlot), VelocityThreshold));
+		ChangedMask = VectorBitwiseOr(ChangedMask, VectorCompareGT(DistanceSquared(Current, Sent, AngularVelocityX, FirstSlot), VelocityThreshold));
+
+		// q and -q are the same rotation, the angle between them is 2 * acos(|q1 . q2|)
+		ChangedMask = VectorBitwiseOr(ChangedMask, VectorCompareGT(LoadLane(RotationThresholdCos, FirstSlot), VectorAbs(Dot(Current, Sent, RotationX, 4, FirstSlot))));
+
+		ChangedMask = VectorBitwiseOr(ChangedMask, StoppedOrStarted(Current, Sent, LinearVelocityX, FirstSlot));
+		ChangedMask = VectorBitwiseOr(ChangedMask, StoppedOrStarted(Current, Sent, AngularVelocityX, FirstSlot));
+
+		const int32 ChangedBits = VectorMaskBits(ChangedMask);
+		const int32 LastSlot = FMath::Min(FirstSlot + LaneWidth, NumSlots);
+		for (int32 Slot = FirstSlot; Slot < LastSlot; ++Slot)
 		{
-			if (Bucket.Value.Callbacks[i].IsBoundToObject(ObjectToRemove))
+			uint8& SlotFlags = Flags[Slot];
+			if (!(SlotFlags & Valid))
+				continue;
+
+			const bool bSleepChanged = !!(SlotFlags & Sleeping) != !!(SlotFlags & SentSleeping);
+			if ((ChangedBits & (1 << (Slot - FirstSlot))) || bSleepChanged || !(SlotFlags & HasSent))
 			{
-				Bucket.Value.Callbacks.RemoveAt(i);
-				bRemovedObject = true;
+				SlotFlags |= Changed;
+				++NumChanged;
 			}
 		}
 	}
-
-	return bRemovedObject;
 }
 
-bool FUpdatePhysicsBucketContainer::IsObjectInBucket(UObject* ObjectToRemove)
+void FPhysicsStateGatherBuffer::MarkSent(int32 Slot)
 {
-	if (!ObjectToRemove)
-		return false;
-	for (auto& Bucket : ReplicationBuckets)
+	for (int32 Lane = 0; Lane < NumLanes; ++Lane)
 	{
-		for (int i = Bucket.Value.Callbacks.Num() - 1; i >= 0; --i)
-		{
-			if (Bucket.Value.Callbacks[i].IsBoundToObject(ObjectToRemove))
-			{
-				return true;
-			}
-		}
+		Sent[Lane][Slot] = Current[Lane][Slot];
 	}
 
-	return false;
+	uint8& SlotFlags = Flags[Slot];
+	SlotFlags = (uint8)((SlotFlags & ~(SentSleeping | Changed)) | HasSent | ((SlotFlags & Sleeping) ? SentSleeping : 0));
 }
 
-bool FUpdatePhysicsBucketContainer::IsObjectFunctionInBucket(UObject* ObjectToRemove, FName FunctionName)
+void FPhysicsStateGatherBuffer::GetState(int32 Slot, FGatheredPhysicsState& OutState) const
 {
-	if (!ObjectToRemove)
-		return false;
-	for (auto& Bucket : ReplicationBuckets)
+	const uint8 SlotFlags = Flags[Slot];
+
+	OutState.State.Position = FVector(Current[LocationX][Slot], Current[LocationY][Slot], Current[LocationZ][Slot]);
+	OutState.State.Quaternion = FQuat(Current[RotationX][Slot], Current[RotationY][Slot], Current[RotationZ][Slot], Current[RotationW][Slot]);
+	OutState.State.LinVel = FVector(Current[LinearVelocityX][Slot], Current[LinearVelocityY][Slot], Current[LinearVelocityZ][Slot]);
+	OutState.State.AngVel = FVector(Current[AngularVelocityX][Slot], Current[AngularVelocityY][Slot], Current[AngularVelocityZ][Slot]);
+	OutState.State.Flags = (SlotFlags & Sleeping) ? ERigidBodyFlags::Sleeping : ERigidBodyFlags::None;
+	OutState.CacheFrame = (SlotFlags & FromCache) ? CacheFrame : 0;
+	OutState.PhysicsFrame = PhysicsFrames[Slot];
+	OutState.bChanged = (SlotFlags & Changed) != 0;
+}
+
+bool UPhysicsBucketUpdateSubsystem::IsTickable() const
+{
+	// When aligned to the net tick the buckets are fired from the world's post actor tick instead
+	return (BucketContainer.bNeedsUpdate && !NetTickHandle.IsValid()) || (!PhysScenePreTickHandle.IsValid() && PendingPrePhysicsApplies.Num() > 0);
+}
+
+UWorld* UPhysicsBucketUpdateSubsystem::GetTickableGameObjectWorld() const
+{
+	return GetWorld();
+}
+
+bool UPhysicsBucketUpdateSubsystem::IsTickableInEditor() const
+{
+	return false;
+}
+
+bool UPhysicsBucketUpdateSubsystem::IsTickableWhenPaused() const
+{
+	return false;
+}
+
+ETickableTickType UPhysicsBucketUpdateSubsystem::GetTickableTickType() const
+{
+	if (IsTemplate(RF_ClassDefaultObject))
+		return ETickableTickType::Never;
+
+	return ETickableTickType::Conditional;
+}
+
+TStatId UPhysicsBucketUpdateSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UPhysicsBucketUpdateSubsystem, STATGROUP_ReplicatedPhysics);
+}
+
+bool FUpdatePhysicsBucketDrop::ExecuteBoundCallback()
+{
+	if (NativeCallback.IsBound())
+	{
+		return NativeCallback.Execute();
+	}
+	else if (DynamicCallback.IsBound())
+	{
+		DynamicCallback.Execute();
+		return true;
+	}
+
+	return false;
+}
+
+bool FUpdatePhysicsBucketDrop::IsBoundToObjectFunction(UObject* Obj, FName& FuncName)
+{
+	return (NativeCallback.IsBoundToObject(Obj) && FunctionName == FuncName);
+}
+
+bool FUpdatePhysicsBucketDrop::IsBoundToObjectDelegate(FDynamicPhysicsBucketUpdateTickSignature& DynEvent)
+{
+	return DynamicCallback == DynEvent;
+}
+
+bool FUpdatePhysicsBucketDrop::IsBoundToObject(UObject* Obj)
+{
+	return (NativeCallback.IsBoundToObject(Obj) || DynamicCallback.IsBoundToObject(Obj));
+}
+
+FUpdatePhysicsBucketDrop::FUpdatePhysicsBucketDrop()
+{
+	FunctionName = NAME_None;
+	bHasGatherStage = false;
+	bGatherNeedsCommit = true;
+	BucketKey = 0;
+	PhaseIndex = INDEX_NONE;
+	IndexInPhase = INDEX_NONE;
+	Serial = 0;
+	bIsRegistered = false;
+	bIsLinked = false;
+	bIsOneShot = false;
+	DeadlineTick = 0;
+	TimerSlot = INDEX_NONE;
+	IndexInTimerSlot = INDEX_NONE;
+	Priority = 1.0f;
+	DueTime = 0.0;
+	LastLateness = 0.0f;
+	bIsQueued = false;
+}
+
+FUpdatePhysicsBucketDrop::FUpdatePhysicsBucketDrop(FDynamicPhysicsBucketUpdateTickSignature& DynCallback) :
+	FUpdatePhysicsBucketDrop()
+{
+	DynamicCallback = DynCallback;
+	BoundObject = FObjectKey(DynCallback.GetUObject());
+}
+
+FUpdatePhysicsBucketDrop::FUpdatePhysicsBucketDrop(UObject* Obj, FName FuncName) :
+	FUpdatePhysicsBucketDrop()
+{
+	if (Obj && Obj->FindFunction(FuncName))
+	{
+		FunctionName = FuncName;
+		NativeCallback.BindUFunction(Obj, FunctionName);
+		BoundObject = FObjectKey(Obj);
+	}
+}
+
+FUpdatePhysicsBucket::FUpdatePhysicsBucket(int32 InPeriodTicks, int32 PhaseCount, uint64 InOriginTick, TStatId InStatId) :
+	PeriodTicks(FMath::Max(InPeriodTicks, 1)),
+	OriginTick(InOriginTick),
+	NumEntries(0),
+	StatId(InStatId)
+{
+	// A period can't be sliced finer than one phase per tick
+	Phases.SetNum(FMath::Clamp(PhaseCount, 1, PeriodTicks));
+}
+
+int32 FUpdatePhysicsBucket::GetPhaseForTick(uint64 Tick) const
+{
+	// Phase N fires on tick N * Period / NumPhases of the period, the first one a full period after the bucket was created
+	const int32 NumPhases = Phases.Num();
+	const int32 LocalTick = (int32)((Tick - OriginTick) % PeriodTicks);
+	const int32 PhaseIndex = FMath::DivideAndRoundUp(LocalTick * NumPhases, PeriodTicks);
+
+	return (PhaseIndex < NumPhases && (PhaseIndex * PeriodTicks) / NumPhases == LocalTick) ? PhaseIndex : INDEX_NONE;
+}
+
+bool FUpdatePhysicsBucket::Update(uint64 FirstTick, int32 NumTicks, FUpdatePhysicsBucketContainer& Container)
+{
+	if (NumEntries < 1 || NumTicks < 1)
+		return NumEntries > 0;
+
+	FScopeCycleCounter CycleCounter(StatId);
+
+	const int32 NumPhases = Phases.Num();
+	if (NumTicks >= PeriodTicks)
+	{
+		// A full period (or more) passed this update, fire every phase once so that no entry ever gets polled twice in the same frame
+		const int32 FirstLocalTick = (int32)((FirstTick - OriginTick) % PeriodTicks);
+		for (int32 PhaseIndex = 0; PhaseIndex < NumPhases; ++PhaseIndex)
+		{
+			// The phase only dropped a fire if its tick came around more than once in the ticks this update covers
+			const int32 PhaseTick = (PhaseIndex * PeriodTicks) / NumPhases;
+			const int32 TicksUntilPhase = (PhaseTick - FirstLocalTick + PeriodTicks) % PeriodTicks;
+			if (NumTicks - TicksUntilPhase > PeriodTicks)
+			{
+				++Container.FrameStats.NumOverruns;
+			}
+
+			FirePhase(PhaseIndex, Container);
+		}
+	}
+	else
 	{
-		for (int i = Bucket.Value.Callbacks.Num() - 1; i >= 0; --i)
+		// A batched bucket has a single phase that fires once per period, a staggered one fires a slice of its entries every phase
+		for (int32 i = 0; i < NumTicks; ++i)
 		{
-			if (Bucket.Value.Callbacks[i].IsBoundToObjectFunction(ObjectToRemove, FunctionName))
+			const int32 PhaseIndex = GetPhaseForTick(FirstTick + i);
+			if (PhaseIndex != INDEX_NONE)
 			{
-				return true;
+				FirePhase(PhaseIndex, Container);
 			}
 		}
 	}
 
-	return false;
+	return NumEntries > 0;
+}
+
+void FUpdatePhysicsBucket::FirePhase(int32 PhaseIndex, FUpdatePhysicsBucketContainer& Container)
+{
+	// Structural changes are deferred while dispatching, so the phase can't change underneath us here
+	const FUpdatePhysicsBucketPhase& Phase = Phases[PhaseIndex];
+	if (Container.HasFrameBudget())
+	{
+		// Only mark the phase as due, the container decides what fits in this update once every bucket has been checked
+		for (const int32 EntryIndex : Phase.Entries)
+		{
+			Container.QueueEntry(EntryIndex);
+		}
+		return;
+	}
+
+	if (Phase.NumGatherEntries > 0)
+	{
+		Container.ExecuteGatherCommit(Phase.Entries);
+		return;
+	}
+
+	for (const int32 EntryIndex : Phase.Entries)
+	{
+		Container.ExecuteEntry(EntryIndex);
+	}
+}
+
+int32 FUpdatePhysicsBucket::GetLeastPopulatedPhase() const
+{
+	int32 BestPhase = 0;
+	for (int32 i = 1; i < Phases.Num(); ++i)
+	{
+		if (Phases[i].Entries.Num() < Phases[BestPhase].Entries.Num())
+		{
+			BestPhase = i;
+		}
+	}
+
+	return BestPhase;
+}
+
+void FUpdatePhysicsBucketContainer::UpdateBuckets(float DeltaTime)
+{
+	SCOPE_CYCLE_COUNTER(STAT_PhysicsBucketUpdate);
+	TRACE_CPUPROFILER_EVENT_SCOPE(FUpdatePhysicsBucketContainer::UpdateBuckets);
+	CSV_SCOPED_TIMING_STAT(ReplicatedPhysics, UpdateBuckets);
+
+	SchedulerTime += DeltaTime;
+
+	// Work out how many wheel ticks this update covers, the fraction carries over to the next one
+	TickAccumulator += DeltaTime * TickRate;
+	const int64 NumTicks = FMath::FloorToInt64(TickAccumulator);
+	TickAccumulator -= NumTicks;
+	const uint64 FirstTick = CurrentTick + 1;
+
+	bIsDispatching = true;
+	if (NumTicks > 0)
+	{
+		if (NumTimers > 0)
+		{
+			AdvanceTimers(NumTicks);
+		}
+		else
+		{
+			CurrentTick += NumTicks;
+		}
+
+		// Buckets only care about ticks up to their period, anything past that fires every phase once
+		const int32 NumBucketTicks = (int32)FMath::Min<int64>(NumTicks, MAX_int32);
+		for (auto& Bucket : ReplicationBuckets)
+		{
+			Bucket.Value.Update(FirstTick, NumBucketTicks, *this);
+		}
+	}
+
+	// Also drains what was left over if the budget was just turned off
+	if (ReadyQueue.Num() > 0)
+	{
+		DispatchQueuedEntries(DeltaTime);
+	}
+	bIsDispatching = false;
+
+	FlushPendingMutations();
+
+	// Remove unused buckets so that they don't get ticked
+	for (auto It = ReplicationBuckets.CreateIterator(); It; ++It)
+	{
+		if (It.Value().NumEntries < 1)
+		{
+			It.RemoveCurrent();
+		}
+	}
+
+	if (ReplicationBuckets.Num() < 1 && ReadyQueue.Num() < 1 && NumTimers < 1)
+		bNeedsUpdate = false;
+
+	// Removals made outside of the update since the last one are counted towards this frame as well
+	SET_DWORD_STAT(STAT_PhysicsBucketNumBuckets, ReplicationBuckets.Num());
+	SET_DWORD_STAT(STAT_PhysicsBucketLiveCallbacks, NumRegisteredEntries);
+	INC_DWORD_STAT_BY(STAT_PhysicsBucketFires, FrameStats.NumFires);
+	INC_DWORD_STAT_BY(STAT_PhysicsBucketRemovals, FrameStats.NumRemovals);
+	INC_DWORD_STAT_BY(STAT_PhysicsBucketOverruns, FrameStats.NumOverruns);
+	INC_DWORD_STAT_BY(STAT_PhysicsBucketPurged, FrameStats.NumPurged);
+	SET_DWORD_STAT(STAT_PhysicsBucketDeferred, FrameStats.NumDeferred);
+	SET_FLOAT_STAT(STAT_PhysicsBucketMaxLateness, FrameStats.MaxLateness * 1000.0f);
+
+	CSV_CUSTOM_STAT(ReplicatedPhysics, LiveCallbacks, NumRegisteredEntries, ECsvCustomStatOp::Set);
+	CSV_CUSTOM_STAT(ReplicatedPhysics, CallbackFires, FrameStats.NumFires, ECsvCustomStatOp::Set);
+	CSV_CUSTOM_STAT(ReplicatedPhysics, CallbackRemovals, FrameStats.NumRemovals, ECsvCustomStatOp::Set);
+	CSV_CUSTOM_STAT(ReplicatedPhysics, BucketOverruns, FrameStats.NumOverruns, ECsvCustomStatOp::Set);
+	CSV_CUSTOM_STAT(ReplicatedPhysics, PurgedCallbacks, FrameStats.NumPurged, ECsvCustomStatOp::Set);
+	CSV_CUSTOM_STAT(ReplicatedPhysics, DeferredCallbacks, FrameStats.NumDeferred, ECsvCustomStatOp::Set);
+	CSV_CUSTOM_STAT(ReplicatedPhysics, MaxLatenessMs, FrameStats.MaxLateness * 1000.0f, ECsvCustomStatOp::Set);
+
+	LastFrameStats = FrameStats;
+	FrameStats = FPhysicsBucketFrameStats();
+}
+
+void FUpdatePhysicsBucketContainer::SetDispatchMode(EPhysicsBucketDispatchMode NewDispatchMode)
+{
+	if (bIsDispatching)
+	{
+		// Re-slicing moves every entry between phases, wait until the buckets are done firing
+		bHasPendingDispatchMode = true;
+		PendingDispatchMode = NewDispatchMode;
+		return;
+	}
+
+	if (DispatchMode == NewDispatchMode)
+		return;
+
+	DispatchMode = NewDispatchMode;
+
+	// Rebuild every bucket with the new phase count and re-link its entries so that they get redistributed
+	TArray<int32> BucketEntries;
+	for (auto& Bucket : ReplicationBuckets)
+	{
+		BucketEntries.Reset();
+		for (const FUpdatePhysicsBucketPhase& Phase : Bucket.Value.Phases)
+		{
+			BucketEntries.Append(Phase.Entries);
+		}
+
+		Bucket.Value = FUpdatePhysicsBucket(Bucket.Key, GetPhaseCountForPeriod(Bucket.Key), CurrentTick, GetBucketStatId(Bucket.Key));
+		for (const int32 EntryIndex : BucketEntries)
+		{
+			LinkEntry(EntryIndex, Bucket.Key);
+		}
+	}
+}
+
+int32 FUpdatePhysicsBucketContainer::GetPhaseCountForPeriod(int32 PeriodTicks) const
+{
+	if (DispatchMode != EPhysicsBucketDispatchMode::Staggered || PeriodTicks < 2)
+		return 1;
+
+	// One phase per tick of the period, a bucket that fires every tick gains nothing from being split up
+	return FMath::Clamp(PeriodTicks, 1, FMath::Max(GPhysicsBucketMaxStaggerPhases, 1));
+}
+
+int32 FUpdatePhysicsBucketContainer::GetPeriodTicksForRate(uint32 UpdateHTZ) const
+{
+	if (UpdateHTZ < 1)
+		return 1;
+
+	// Snap to the nearest period, rounding down would put everything between half and the full tick rate on every tick
+	return FMath::Max(FMath::RoundToInt32(TickRate / UpdateHTZ), 1);
+}
+
+bool FUpdatePhysicsBucketContainer::SetTickRate(float NewTickRate)
+{
+	// Every bucket key and timer deadline is in ticks, changing the resolution would shift all of them
+	if (NumRegisteredEntries > 0 || bIsDispatching)
+	{
+		UE_LOG(LogReplicatedPhysics, Warning, TEXT("Bucket tick rate can only be changed while no entries are registered"));
+		return false;
+	}
+
+	TickRate = FMath::Max(NewTickRate, 1.0f);
+	TickAccumulator = 0.0;
+
+	// The counter names carry the rate of their period
+	BucketStatIds.Reset();
+	return true;
+}
+
+TStatId FUpdatePhysicsBucketContainer::GetBucketStatId(uint32 PeriodTicks)
+{
+#if STATS
+	if (const TStatId* Found = BucketStatIds.Find(PeriodTicks))
+		return *Found;
+
+	return BucketStatIds.Add(PeriodTicks, FDynamicStats::CreateStatId<FStatGroup_STATGROUP_ReplicatedPhysics>(FString::Printf(TEXT("Bucket %.1f Hz"), TickRate / PeriodTicks)));
+#else
+	return TStatId();
+#endif
+}
+
+void FUpdatePhysicsBucketContainer::SetFrameBudget(float BudgetMs, int32 MaxCallbacks)
+{
+	FrameBudgetSeconds = FMath::Max(BudgetMs, 0.0f) / 1000.0;
+	MaxCallbacksPerFrame = FMath::Max(MaxCallbacks, 0);
+}
+
+void FUpdatePhysicsBucketContainer::QueueEntry(int32 EntryIndex)
+{
+	FUpdatePhysicsBucketDrop& Entry = Entries[EntryIndex];
+	if (!Entry.bIsRegistered || Entry.bIsQueued)
+		return;
+
+	// An entry that is still waiting from an earlier fire simply keeps its place, its repeat fires are folded into it
+	Entry.bIsQueued = true;
+	Entry.DueTime = SchedulerTime;
+
+	FPhysicsBucketQueuedEntry& Queued = ReadyQueue.AddDefaulted_GetRef();
+	Queued.EntryIndex = EntryIndex;
+	Queued.Serial = Entry.Serial;
+	Queued.Score = 0.0f;
+}
+
+void FUpdatePhysicsBucketContainer::DispatchQueuedEntries(float DeltaTime)
+{
+	// Lateness is counted up to the end of this update so that entries that just became due are still ordered by priority
+	for (FPhysicsBucketQueuedEntry& Queued : ReadyQueue)
+	{
+		const FUpdatePhysicsBucketDrop& Entry = Entries[Queued.EntryIndex];
+		const bool bIsStale = !Entry.bIsRegistered || Entry.Serial != Queued.Serial || !Entry.bIsQueued;
+		Queued.Score = bIsStale ? -1.0f : (float)(SchedulerTime - Entry.DueTime + DeltaTime) * FMath::Max(Entry.Priority, UE_KINDA_SMALL_NUMBER);
+	}
+
+	ReadyQueue.Sort([](const FPhysicsBucketQueuedEntry& A, const FPhysicsBucketQueuedEntry& B)
+	{
+		return A.Score > B.Score;
+	});
+
+	const double StartTime = FPlatformTime::Seconds();
+	const int32 MaxBatch = FMath::Max(GPhysicsBucketParallelGatherMinBatch, 1);
+	int32 NumDispatched = 0;
+	int32 Cursor = 0;
+
+	auto IsBudgetExhausted = [this, &NumDispatched, StartTime]()
+	{
+		if (!HasFrameBudget())
+			return false;
+
+		if (MaxCallbacksPerFrame > 0 && NumDispatched >= MaxCallbacksPerFrame)
+			return true;
+
+		// Always make progress, at least one batch fires every update regardless of the time budget
+		return FrameBudgetSeconds > 0.0 && NumDispatched > 0 && (FPlatformTime::Seconds() - StartTime) >= FrameBudgetSeconds;
+	};
+
+	while (Cursor < ReadyQueue.Num() && !IsBudgetExhausted())
+	{
+		// Two phase entries are batched so that their gather stage can still go wide, regular entries fire one at a time
+		// so that the time budget is checked between every callback
+		const int32 BatchLimit = MaxCallbacksPerFrame > 0 ? FMath::Min(MaxBatch, MaxCallbacksPerFrame - NumDispatched) : MaxBatch;
+		bool bBatchHasGatherStage = false;
+		ScratchBatch.Reset();
+
+		while (Cursor < ReadyQueue.Num() && ScratchBatch.Num() < BatchLimit)
+		{
+			const FPhysicsBucketQueuedEntry& Queued = ReadyQueue[Cursor];
+			if (Queued.Score < 0.0f)
+			{
+				// Stale entries sort to the back, there is nothing left to fire past them
+				Cursor = ReadyQueue.Num();
+				break;
+			}
+
+			FUpdatePhysicsBucketDrop& Entry = Entries[Queued.EntryIndex];
+			if (ScratchBatch.Num() > 0 && !Entry.bHasGatherStage)
+				break;
+
+			++Cursor;
+			Entry.bIsQueued = false;
+			Entry.LastLateness = (float)(SchedulerTime - Entry.DueTime);
+			FrameStats.MaxLateness = FMath::Max(FrameStats.MaxLateness, Entry.LastLateness);
+			ScratchBatch.Add(Queued.EntryIndex);
+
+			bBatchHasGatherStage = Entry.bHasGatherStage;
+			if (!bBatchHasGatherStage)
+				break;
+		}
+
+		if (ScratchBatch.Num() < 1)
+			break;
+
+		if (bBatchHasGatherStage)
+		{
+			ExecuteGatherCommit(ScratchBatch);
+		}
+		else
+		{
+			ExecuteEntry(ScratchBatch[0]);
+		}
+
+		NumDispatched += ScratchBatch.Num();
+	}
+
+	// Carry what didn't fit over to the next update, dropping anything that was removed while it waited
+	ReadyQueue.RemoveAt(0, Cursor, EAllowShrinking::No);
+	ReadyQueue.RemoveAllSwap([](const FPhysicsBucketQueuedEntry& Queued)
+	{
+		return Queued.Score < 0.0f;
+	}, EAllowShrinking::No);
+
+	FrameStats.NumDeferred = ReadyQueue.Num();
+}
+
+bool FUpdatePhysicsBucketContainer::SetBucketEntryPriority(const FPhysicsBucketHandle& Handle, float NewPriority)
+{
+	if (!IsBucketEntryRegistered(Handle))
+		return false;
+
+	GetEntry(Handle.Index).Priority = NewPriority;
+	return true;
+}
+
+float FUpdatePhysicsBucketContainer::GetBucketEntryLateness(const FPhysicsBucketHandle& Handle) const
+{
+	if (!IsBucketEntryRegistered(Handle))
+		return 0.0f;
+
+	const FUpdatePhysicsBucketDrop& Entry = GetEntry(Handle.Index);
+	return Entry.bIsQueued ? (float)(SchedulerTime - Entry.DueTime) : Entry.LastLateness;
+}
+
+FPhysicsBucketHandle FUpdatePhysicsBucketContainer::AddBucketEntry(uint32 UpdateHTZ, const FUpdatePhysicsBucketDrop& Callback)
+{
+	if (UpdateHTZ < 1 || (!Callback.NativeCallback.IsBound() && !Callback.DynamicCallback.IsBound()))
+		return FPhysicsBucketHandle();
+
+	FUpdatePhysicsBucketDrop PeriodicCallback = Callback;
+	PeriodicCallback.bIsOneShot = false;
+	PeriodicCallback.BucketKey = GetPeriodTicksForRate(UpdateHTZ);
+	return RegisterEntry(PeriodicCallback);
+}
+
+FPhysicsBucketHandle FUpdatePhysicsBucketContainer::AddTimerEntry(float DelaySeconds, const FUpdatePhysicsBucketDrop& Callback)
+{
+	if (!Callback.NativeCallback.IsBound() && !Callback.DynamicCallback.IsBound())
+		return FPhysicsBucketHandle();
+
+	// Always at least one tick out, the tick currently being processed (if any) is already past its firing point
+	FUpdatePhysicsBucketDrop TimerCallback = Callback;
+	TimerCallback.bIsOneShot = true;
+	TimerCallback.BucketKey = 0;
+	TimerCallback.DeadlineTick = CurrentTick + (uint64)FMath::Max(FMath::CeilToInt64((double)DelaySeconds * TickRate), (int64)1);
+	return RegisterEntry(TimerCallback);
+}
+
+float FUpdatePhysicsBucketContainer::GetTimerRemaining(const FPhysicsBucketHandle& Handle) const
+{
+	if (!IsBucketEntryRegistered(Handle))
+		return -1.0f;
+
+	const FUpdatePhysicsBucketDrop& Entry = GetEntry(Handle.Index);
+	if (!Entry.bIsOneShot)
+		return -1.0f;
+
+	// Fired but still waiting on the frame budget
+	if (Entry.DeadlineTick <= CurrentTick)
+		return 0.0f;
+
+	return (float)(((double)(Entry.DeadlineTick - CurrentTick) - TickAccumulator) / TickRate);
+}
+
+FPhysicsBucketHandle FUpdatePhysicsBucketContainer::RegisterEntry(const FUpdatePhysicsBucketDrop& Callback)
+{
+	// While dispatching the entry array can't grow as a callback may be executing out of it,
+	// new slots go to the pending list and are appended once the buckets are done firing
+	int32 EntryIndex = INDEX_NONE;
+	if (FreeEntries.Num() > 0)
+	{
+		EntryIndex = FreeEntries.Pop(EAllowShrinking::No);
+	}
+	else if (bIsDispatching)
+	{
+		EntryIndex = Entries.Num() + PendingEntries.AddDefaulted();
+	}
+	else
+	{
+		EntryIndex = Entries.AddDefaulted();
+	}
+
+	FUpdatePhysicsBucketDrop& Entry = GetEntry(EntryIndex);
+
+	// Serials keep counting up through the slot's lifetime so stale handles never resolve to a new registration
+	const uint32 NextSerial = Entry.Serial + 1;
+
+	Entry = Callback;
+	Entry.Serial = NextSerial;
+	Entry.bIsRegistered = true;
+	Entry.bIsLinked = false;
+	Entry.bIsQueued = false;
+	Entry.LastLateness = 0.0f;
+	++NumRegisteredEntries;
+
+	if (Entry.bIsOneShot)
+	{
+		++NumTimers;
+	}
+
+	// Latched here, the delegate stops reporting as bound once its object is gone
+	Entry.bHasGatherStage = Entry.GatherCallback.IsBound();
+	if (Entry.bHasGatherStage)
+	{
+		++NumGatherEntries;
+	}
+
+	if (Entry.BoundObject != FObjectKey())
+	{
+		ObjectEntries.FindOrAdd(Entry.BoundObject).Add(EntryIndex);
+	}
+
+	if (bIsDispatching)
+	{
+		PendingLinks.Add(EntryIndex);
+	}
+	else if (Entry.bIsOneShot)
+	{
+		LinkTimer(EntryIndex, CurrentTick + 1);
+	}
+	else
+	{
+		LinkEntry(EntryIndex, Entry.BucketKey);
+	}
+
+	bNeedsUpdate = true;
+
+	FPhysicsBucketHandle Handle;
+	Handle.Index = EntryIndex;
+	Handle.Serial = NextSerial;
+	return Handle;
+}
+
+bool FUpdatePhysicsBucketContainer::RemoveBucketEntry(const FPhysicsBucketHandle& Handle)
+{
+	if (!IsBucketEntryRegistered(Handle))
+		return false;
+
+	RemoveEntry(Handle.Index);
+	return true;
+}
+
+bool FUpdatePhysicsBucketContainer::IsBucketEntryRegistered(const FPhysicsBucketHandle& Handle) const
+{
+	if (Handle.Index < 0 || Handle.Index >= Entries.Num() + PendingEntries.Num())
+		return false;
+
+	const FUpdatePhysicsBucketDrop& Entry = GetEntry(Handle.Index);
+	return Entry.bIsRegistered && Entry.Serial == Handle.Serial;
+}
+
+FPhysicsBucketHandle FUpdatePhysicsBucketContainer::AddBucketObject(uint32 UpdateHTZ, UObject* InObject, FName FunctionName, float Priority)
+{
+	if (!InObject || InObject->FindFunction(FunctionName) == nullptr || UpdateHTZ < 1)
+		return FPhysicsBucketHandle();
+
+	// First verify that this object isn't already contained in a bucket, if it is then erase it so that we can replace it below
+	RemoveBucketObject(InObject, FunctionName);
+
+	FUpdatePhysicsBucketDrop Callback(InObject, FunctionName);
+	Callback.Priority = Priority;
+	return AddBucketEntry(UpdateHTZ, Callback);
+}
+
+FPhysicsBucketHandle FUpdatePhysicsBucketContainer::AddBucketObject(uint32 UpdateHTZ, FDynamicPhysicsBucketUpdateTickSignature& Delegate, float Priority)
+{
+	if (!Delegate.IsBound() || UpdateHTZ < 1)
+		return FPhysicsBucketHandle();
+
+	// First verify that this object isn't already contained in a bucket, if it is then erase it so that we can replace it below
+	RemoveBucketObject(Delegate);
+
+	FUpdatePhysicsBucketDrop Callback(Delegate);
+	Callback.Priority = Priority;
+	return AddBucketEntry(UpdateHTZ, Callback);
+}
+
+bool FUpdatePhysicsBucketContainer::RemoveBucketObject(UObject* ObjectToRemove, FName FunctionName)
+{
+	const int32 EntryIndex = FindObjectFunctionEntry(ObjectToRemove, FunctionName);
+	if (EntryIndex == INDEX_NONE)
+		return false;
+
+	RemoveEntry(EntryIndex);
+	return true;
+}
+
+bool FUpdatePhysicsBucketContainer::RemoveBucketObject(FDynamicPhysicsBucketUpdateTickSignature& DynEvent)
+{
+	const int32 EntryIndex = FindDelegateEntry(DynEvent);
+	if (EntryIndex == INDEX_NONE)
+		return false;
+
+	RemoveEntry(EntryIndex);
+	return true;
+}
+
+bool FUpdatePhysicsBucketContainer::RemoveObjectFromAllBuckets(UObject* ObjectToRemove)
+{
+	if (!ObjectToRemove)
+		return false;
+
+	TArray<int32, TInlineAllocator<2>> ObjectEntryIndices;
+	if (!ObjectEntries.RemoveAndCopyValue(FObjectKey(ObjectToRemove), ObjectEntryIndices))
+		return false;
+
+	for (const int32 EntryIndex : ObjectEntryIndices)
+	{
+		RemoveEntry(EntryIndex);
+	}
+
+	return ObjectEntryIndices.Num() > 0;
+}
+
+int32 FUpdatePhysicsBucketContainer::PurgeDeadEntries()
+{
+	SCOPE_CYCLE_COUNTER(STAT_PhysicsBucketPurge);
+	TRACE_CPUPROFILER_EVENT_SCOPE(FUpdatePhysicsBucketContainer::PurgeDeadEntries);
+
+	// A key stops resolving as soon as its object is unreachable, so everything found here is dead
+	// Every entry is bound to its key's object, so this catches them all without touching the delegates
+	int32 NumPurged = 0;
+	for (auto It = ObjectEntries.CreateIterator(); It; ++It)
+	{
+		if (It.Key().ResolveObjectPtr() != nullptr)
+			continue;
+
+		// Removing unlinks the entry from its phase or timer slot with a swap, so the buckets stay dense
+		TArray<int32, TInlineAllocator<2>> DeadEntries = MoveTemp(It.Value());
+		It.RemoveCurrent();
+
+		for (const int32 EntryIndex : DeadEntries)
+		{
+			FUpdatePhysicsBucketDrop& Entry = GetEntry(EntryIndex);
+			if (!Entry.bIsRegistered)
+				continue;
+
+			// Already out of the object index, RemoveEntry only has to unregister and unlink it
+			Entry.BoundObject = FObjectKey();
+			RemoveEntry(EntryIndex);
+			++NumPurged;
+		}
+	}
+
+	FrameStats.NumPurged += NumPurged;
+	return NumPurged;
+}
+
+bool FUpdatePhysicsBucketContainer::IsObjectInBucket(UObject* ObjectToRemove)
+{
+	if (!ObjectToRemove)
+		return false;
+
+	return ObjectEntries.Contains(FObjectKey(ObjectToRemove));
+}
+
+bool FUpdatePhysicsBucketContainer::IsObjectFunctionInBucket(UObject* ObjectToRemove, FName FunctionName)
+{
+	return FindObjectFunctionEntry(ObjectToRemove, FunctionName) != INDEX_NONE;
 }
 
 bool FUpdatePhysicsBucketContainer::IsObjectDelegateInBucket(FDynamicPhysicsBucketUpdateTickSignature& DynEvent)
+{
+	return FindDelegateEntry(DynEvent) != INDEX_NONE;
+}
+
+void FUpdatePhysicsBucketContainer::ExecuteEntry(int32 EntryIndex)
+{
+	// Entries removed earlier in this dispatch stay in their phase until the flush, skip them
+	FUpdatePhysicsBucketDrop& Entry = Entries[EntryIndex];
+	if (!Entry.bIsRegistered)
+		return;
+
+	++FrameStats.NumFires;
+	if (!Entry.ExecuteBoundCallback() || Entry.bIsOneShot)
+	{
+		// Remove the callback, it is complete, invalid or was only meant to fire once
+		// If the callback already removed itself this does nothing, its slot isn't re-used until the flush
+		RemoveEntry(EntryIndex);
+	}
+}
+
+void FUpdatePhysicsBucketContainer::ExecuteGatherCommit(const TArray<int32>& PhaseEntries)
+{
+	// Entries without a gather stage always commit, they are just regular callbacks sharing the phase
+	auto GatherEntry = [this, &PhaseEntries](int32 PhaseEntryIndex)
+	{
+		FUpdatePhysicsBucketDrop& Entry = Entries[PhaseEntries[PhaseEntryIndex]];
+		Entry.bGatherNeedsCommit = Entry.bIsRegistered && (!Entry.GatherCallback.IsBound() || Entry.GatherCallback.Execute());
+	};
+
+	{
+		SCOPE_CYCLE_COUNTER(STAT_PhysicsBucketGather);
+		TRACE_CPUPROFILER_EVENT_SCOPE(PhysicsBucketGather);
+
+		const int32 NumToGather = PhaseEntries.Num();
+		if (GPhysicsBucketParallelGather && NumToGather >= GPhysicsBucketParallelGatherMinBatch)
+		{
+			ParallelFor(NumToGather, GatherEntry);
+		}
+		else
+		{
+			for (int32 i = 0; i < NumToGather; ++i)
+			{
+				GatherEntry(i);
+			}
+		}
+	}
+
+	SCOPE_CYCLE_COUNTER(STAT_PhysicsBucketCommit);
+	TRACE_CPUPROFILER_EVENT_SCOPE(PhysicsBucketCommit);
+
+	for (const int32 EntryIndex : PhaseEntries)
+	{
+		// An earlier commit may have removed this entry, ExecuteEntry skips it in that case
+		if (Entries[EntryIndex].bGatherNeedsCommit)
+		{
+			ExecuteEntry(EntryIndex);
+		}
+	}
+}
+
+FUpdatePhysicsBucketDrop& FUpdatePhysicsBucketContainer::GetEntry(int32 EntryIndex)
+{
+	return EntryIndex < Entries.Num() ? Entries[EntryIndex] : PendingEntries[EntryIndex - Entries.Num()];
+}
+
+const FUpdatePhysicsBucketDrop& FUpdatePhysicsBucketContainer::GetEntry(int32 EntryIndex) const
+{
+	return EntryIndex < Entries.Num() ? Entries[EntryIndex] : PendingEntries[EntryIndex - Entries.Num()];
+}
+
+int32 FUpdatePhysicsBucketContainer::FindObjectFunctionEntry(UObject* InObject, FName FunctionName) const
+{
+	// Unnamed native entries can only be reached through their handle
+	if (!InObject || FunctionName.IsNone())
+		return INDEX_NONE;
+
+	if (const TArray<int32, TInlineAllocator<2>>* ObjectEntryIndices = ObjectEntries.Find(FObjectKey(InObject)))
+	{
+		for (const int32 EntryIndex : *ObjectEntryIndices)
+		{
+			const FUpdatePhysicsBucketDrop& Entry = GetEntry(EntryIndex);
+			if (Entry.NativeCallback.IsBound() && Entry.FunctionName == FunctionName)
+			{
+				return EntryIndex;
+			}
+		}
+	}
+
+	return INDEX_NONE;
+}
+
+int32 FUpdatePhysicsBucketContainer::FindDelegateEntry(FDynamicPhysicsBucketUpdateTickSignature& DynEvent) const
 {
 	if (!DynEvent.IsBound())
-		return false;
+		return INDEX_NONE;
 
-	for (auto& Bucket : ReplicationBuckets)
+	if (const TArray<int32, TInlineAllocator<2>>* ObjectEntryIndices = ObjectEntries.Find(FObjectKey(DynEvent.GetUObject())))
 	{
-		for (int i = Bucket.Value.Callbacks.Num() - 1; i >= 0; --i)
+		for (const int32 EntryIndex : *ObjectEntryIndices)
 		{
-			if (Bucket.Value.Callbacks[i].IsBoundToObjectDelegate(DynEvent))
+			if (GetEntry(EntryIndex).DynamicCallback == DynEvent)
 			{
-				return true;
+				return EntryIndex;
 			}
 		}
 	}
 
-	return false;
+	return INDEX_NONE;
+}
+
+void FUpdatePhysicsBucketContainer::LinkEntry(int32 EntryIndex, uint32 PeriodTicks)
+{
+	FUpdatePhysicsBucket* Bucket = ReplicationBuckets.Find(PeriodTicks);
+	if (!Bucket)
+	{
+		Bucket = &ReplicationBuckets.Add(PeriodTicks, FUpdatePhysicsBucket(PeriodTicks, GetPhaseCountForPeriod(PeriodTicks), CurrentTick, GetBucketStatId(PeriodTicks)));
+	}
+
+	FUpdatePhysicsBucketDrop& Entry = Entries[EntryIndex];
+	Entry.BucketKey = PeriodTicks;
+	Entry.PhaseIndex = Bucket->GetLeastPopulatedPhase();
+	Entry.IndexInPhase = Bucket->Phases[Entry.PhaseIndex].Entries.Add(EntryIndex);
+	Entry.bIsLinked = true;
+	++Bucket->NumEntries;
+
+	if (Entry.bHasGatherStage)
+	{
+		++Bucket->Phases[Entry.PhaseIndex].NumGatherEntries;
+	}
+}
+
+void FUpdatePhysicsBucketContainer::LinkTimer(int32 EntryIndex, uint64 EarliestTick)
+{
+	if (TimerWheel.Num() < 1)
+	{
+		TimerWheel.SetNum(TimerWheelLevels * TimerWheelSlots);
+	}
+
+	FUpdatePhysicsBucketDrop& Entry = Entries[EntryIndex];
+
+	// Pick the lowest level that still spans the deadline, an entry in level N is cascaded down once the
+	// ticks below it roll over to its slot. Deadlines past the top level wait at its far end and are re-inserted from there
+	uint64 Deadline = FMath::Max(Entry.DeadlineTick, EarliestTick);
+	int32 Level = 0;
+	while (Level < TimerWheelLevels - 1 && (Deadline - CurrentTick) >= (1ull << (TimerWheelSlotBits * (Level + 1))))
+	{
+		++Level;
+	}
+
+	const uint64 MaxSpan = 1ull << (TimerWheelSlotBits * TimerWheelLevels);
+	if ((Deadline - CurrentTick) >= MaxSpan)
+	{
+		Deadline = CurrentTick + MaxSpan - 1;
+	}
+
+	Entry.TimerSlot = Level * TimerWheelSlots + (int32)((Deadline >> (TimerWheelSlotBits * Level)) & (TimerWheelSlots - 1));
+	Entry.IndexInTimerSlot = TimerWheel[Entry.TimerSlot].Add(EntryIndex);
+	Entry.bIsLinked = true;
+}
+
+void FUpdatePhysicsBucketContainer::AdvanceTimers(int64 NumTicks)
+{
+	for (int64 i = 0; i < NumTicks; ++i)
+	{
+		++CurrentTick;
+
+		// Once the lower bits roll over, pull the matching slot of each level above down, highest first so that
+		// entries landing in the current slot of a lower level are cascaded again right after
+		int32 NumCascadeLevels = 0;
+		while (NumCascadeLevels < TimerWheelLevels - 1 && (CurrentTick & ((1ull << (TimerWheelSlotBits * (NumCascadeLevels + 1))) - 1)) == 0)
+		{
+			++NumCascadeLevels;
+		}
+
+		for (int32 Level = NumCascadeLevels; Level >= 0; --Level)
+		{
+			const int32 SlotIndex = Level * TimerWheelSlots + (int32)((CurrentTick >> (TimerWheelSlotBits * Level)) & (TimerWheelSlots - 1));
+			if (TimerWheel[SlotIndex].Num() < 1)
+				continue;
+
+			// Swap the slot out so that re-inserting can't touch the array we are walking, the scratch keeps its allocation
+			ScratchTimers.Reset();
+			Swap(ScratchTimers, TimerWheel[SlotIndex]);
+
+			for (const int32 EntryIndex : ScratchTimers)
+			{
+				FUpdatePhysicsBucketDrop& Entry = Entries[EntryIndex];
+				Entry.bIsLinked = false;
+				if (!Entry.bIsRegistered)
+					continue;
+
+				if (Level > 0 || Entry.DeadlineTick > CurrentTick)
+				{
+					LinkTimer(EntryIndex, CurrentTick);
+				}
+				else if (HasFrameBudget())
+				{
+					QueueEntry(EntryIndex);
+				}
+				else
+				{
+					ExecuteEntry(EntryIndex);
+				}
+			}
+		}
+
+		if (NumTimers < 1)
+		{
+			CurrentTick += NumTicks - i - 1;
+			return;
+		}
+	}
+}
+
+void FUpdatePhysicsBucketContainer::RemoveEntry(int32 EntryIndex)
+{
+	FUpdatePhysicsBucketDrop& Entry = GetEntry(EntryIndex);
+	if (!Entry.bIsRegistered)
+		return;
+
+	// Unregister right away so that lookups and the dispatch loop stop seeing the entry
+	Entry.bIsRegistered = false;
+	--NumRegisteredEntries;
+	++FrameStats.NumRemovals;
+
+	if (Entry.bIsOneShot)
+	{
+		--NumTimers;
+	}
+
+	if (Entry.bHasGatherStage)
+	{
+		--NumGatherEntries;
+	}
+
+	if (Entry.BoundObject != FObjectKey())
+	{
+		if (TArray<int32, TInlineAllocator<2>>* ObjectEntryIndices = ObjectEntries.Find(Entry.BoundObject))
+		{
+			ObjectEntryIndices->RemoveSingleSwap(EntryIndex, EAllowShrinking::No);
+			if (ObjectEntryIndices->Num() < 1)
+			{
+				ObjectEntries.Remove(Entry.BoundObject);
+			}
+		}
+	}
+
+	// Unlinking swaps entries around in the phase, which isn't safe while it's being fired
+	if (bIsDispatching)
+	{
+		PendingUnlinks.Add(EntryIndex);
+		return;
+	}
+
+	ReleaseEntry(EntryIndex);
+}
+
+void FUpdatePhysicsBucketContainer::ReleaseEntry(int32 EntryIndex)
+{
+	FUpdatePhysicsBucketDrop& Entry = Entries[EntryIndex];
+
+	if (Entry.bIsLinked && Entry.bIsOneShot)
+	{
+		TArray<int32>& TimerSlot = TimerWheel[Entry.TimerSlot];
+		TimerSlot.RemoveAtSwap(Entry.IndexInTimerSlot, 1, EAllowShrinking::No);
+		if (TimerSlot.IsValidIndex(Entry.IndexInTimerSlot))
+		{
+			Entries[TimerSlot[Entry.IndexInTimerSlot]].IndexInTimerSlot = Entry.IndexInTimerSlot;
+		}
+	}
+	else if (Entry.bIsLinked)
+	{
+		if (FUpdatePhysicsBucket* Bucket = ReplicationBuckets.Find(Entry.BucketKey))
+		{
+			FUpdatePhysicsBucketPhase& Phase = Bucket->Phases[Entry.PhaseIndex];
+			if (Entry.bHasGatherStage)
+			{
+				--Phase.NumGatherEntries;
+			}
+
+			// Swap the tail of the phase into our slot so that the removal doesn't shift the rest of the phase
+			Phase.Entries.RemoveAtSwap(Entry.IndexInPhase, 1, EAllowShrinking::No);
+			if (Phase.Entries.IsValidIndex(Entry.IndexInPhase))
+			{
+				Entries[Phase.Entries[Entry.IndexInPhase]].IndexInPhase = Entry.IndexInPhase;
+			}
+
+			--Bucket->NumEntries;
+		}
+	}
+
+	// Keep the serial so that the next registration in this slot continues counting from it
+	const uint32 Serial = Entry.Serial;
+	Entry = FUpdatePhysicsBucketDrop();
+	Entry.Serial = Serial;
+
+	FreeEntries.Add(EntryIndex);
+}
+
+void FUpdatePhysicsBucketContainer::FlushPendingMutations()
+{
+	check(!bIsDispatching);
+
+	// Scratch arrays are reset rather than emptied so that steady state dispatching never allocates
+	if (PendingEntries.Num() > 0)
+	{
+		Entries.Append(PendingEntries);
+		PendingEntries.Reset();
+	}
+
+	for (const int32 EntryIndex : PendingUnlinks)
+	{
+		ReleaseEntry(EntryIndex);
+	}
+	PendingUnlinks.Reset();
+
+	for (const int32 EntryIndex : PendingLinks)
+	{
+		const FUpdatePhysicsBucketDrop& Entry = Entries[EntryIndex];
+		if (Entry.bIsRegistered && !Entry.bIsLinked && Entry.bIsOneShot)
+		{
+			LinkTimer(EntryIndex, CurrentTick + 1);
+		}
+		else if (Entry.bIsRegistered && !Entry.bIsLinked)
+		{
+			LinkEntry(EntryIndex, Entry.BucketKey);
+		}
+	}
+	PendingLinks.Reset();
+
+	if (bHasPendingDispatchMode)
+	{
+		bHasPendingDispatchMode = false;
+		SetDispatchMode(PendingDispatchMode);
+	}
 }
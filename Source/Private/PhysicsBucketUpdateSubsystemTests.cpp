@@ -0,0 +1,204 @@
+// Copyright Hitbox Games, LLC. All Rights Reserved.
+
+#include "PhysicsBucketBenchmarkTarget.h"
+#include "PhysicsBucketUpdateSubsystem.h"
+#include "HAL/MemoryBase.h"
+#include "HAL/PlatformTLS.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace PhysicsBucketUpdateSubsystemTests
+{
+	// Forwards everything to the allocator it wraps and counts the allocations made from the thread that installed it
+	// Other threads keep allocating while it is installed, they are forwarded but not counted
+	class FCountingMallocProxy : public FMalloc
+	{
+	public:
+		explicit FCountingMallocProxy(FMalloc* InInnerMalloc)
+			: InnerMalloc(InInnerMalloc)
+			, OwningThreadId(FPlatformTLS::GetCurrentThreadId())
+		{
+		}
+
+		virtual void* Malloc(SIZE_T Count, uint32 Alignment) override
+		{
+			CountAllocation();
+			return InnerMalloc->Malloc(Count, Alignment);
+		}
+
+		virtual void* TryMalloc(SIZE_T Count, uint32 Alignment) override
+		{
+			CountAllocation();
+			return InnerMalloc->TryMalloc(Count, Alignment);
+		}
+
+		virtual void* Realloc(void* Original, SIZE_T Count, uint32 Alignment) override
+		{
+			CountAllocation();
+			return InnerMalloc->Realloc(Original, Count, Alignment);
+		}
+
+		virtual void* TryRealloc(void* Original, SIZE_T Count, uint32 Alignment) override
+		{
+			CountAllocation();
+			return InnerMalloc->TryRealloc(Original, Count, Alignment);
+		}
+
+		virtual void Free(void* Original) override
+		{
+			InnerMalloc->Free(Original);
+		}
+
+		virtual SIZE_T QuantizeSize(SIZE_T Count, uint32 Alignment) override
+		{
+			return InnerMalloc->QuantizeSize(Count, Alignment);
+		}
+
+		virtual bool GetAllocationSize(void* Original, SIZE_T& SizeOut) override
+		{
+			return InnerMalloc->GetAllocationSize(Original, SizeOut);
+		}
+
+		virtual void Trim(bool bTrimThreadCaches) override
+		{
+			InnerMalloc->Trim(bTrimThreadCaches);
+		}
+
+		virtual void SetupTLSCachesOnCurrentThread() override
+		{
+			InnerMalloc->SetupTLSCachesOnCurrentThread();
+		}
+
+		virtual void ClearAndDisableTLSCachesOnCurrentThread() override
+		{
+			InnerMalloc->ClearAndDisableTLSCachesOnCurrentThread();
+		}
+
+		virtual bool IsInternallyThreadSafe() const override
+		{
+			return InnerMalloc->IsInternallyThreadSafe();
+		}
+
+		virtual bool ValidateHeap() override
+		{
+			return InnerMalloc->ValidateHeap();
+		}
+
+		virtual const TCHAR* GetDescriptiveName() override
+		{
+			return InnerMalloc->GetDescriptiveName();
+		}
+
+		int64 GetNumAllocations() const
+		{
+			return NumAllocations;
+		}
+
+	private:
+		void CountAllocation()
+		{
+			if (FPlatformTLS::GetCurrentThreadId() == OwningThreadId)
+			{
+				++NumAllocations;
+			}
+		}
+
+		FMalloc* InnerMalloc;
+		uint32 OwningThreadId;
+		int64 NumAllocations = 0;
+	};
+
+	// Swaps GMalloc for the counting proxy for its lifetime, the inner allocator frees whatever went through the proxy
+	struct FScopedAllocationCounter
+	{
+		FScopedAllocationCounter()
+			: PreviousMalloc(GMalloc)
+			, Proxy(GMalloc)
+		{
+			GMalloc = &Proxy;
+		}
+
+		~FScopedAllocationCounter()
+		{
+			GMalloc = PreviousMalloc;
+		}
+
+		int64 GetNumAllocations() const
+		{
+			return Proxy.GetNumAllocations();
+		}
+
+		FMalloc* PreviousMalloc;
+		FCountingMallocProxy Proxy;
+	};
+
+	// Same rate mix as the container benchmark
+	static const uint32 SteadyStateRates[] = { 10, 20, 30, 60, 100 };
+}
+
+// Once every bucket exists and has fired, ticking a populated container must not touch the heap
+// Stats and CSV capture allocate on their own while they are collecting, so run this with both off
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FPhysicsBucketSteadyStateAllocationTest, "ReplicatedPhysics.Buckets.SteadyStateAllocations",
+	EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FPhysicsBucketSteadyStateAllocationTest::RunTest(const FString& Parameters)
+{
+	using namespace PhysicsBucketUpdateSubsystemTests;
+
+	constexpr int32 NumEntries = 1000;
+	constexpr int32 NumWarmupFrames = 120;
+	constexpr int32 NumMeasuredFrames = 600;
+
+	TArray<UPhysicsBucketBenchmarkTarget*> Targets;
+	Targets.Reserve(NumEntries);
+	for (int32 i = 0; i < NumEntries; ++i)
+	{
+		UPhysicsBucketBenchmarkTarget* Target = NewObject<UPhysicsBucketBenchmarkTarget>();
+		Target->AddToRoot();
+		Targets.Add(Target);
+	}
+
+	for (const EPhysicsBucketDispatchMode DispatchMode : { EPhysicsBucketDispatchMode::Batched, EPhysicsBucketDispatchMode::Staggered })
+	{
+		const TCHAR* ModeName = DispatchMode == EPhysicsBucketDispatchMode::Staggered ? TEXT("Staggered") : TEXT("Batched");
+
+		FUpdatePhysicsBucketContainer Container;
+		Container.SetDispatchMode(DispatchMode);
+		for (int32 i = 0; i < NumEntries; ++i)
+		{
+			Container.AddReplicatingObject(SteadyStateRates[i % UE_ARRAY_COUNT(SteadyStateRates)], Targets[i], &UPhysicsBucketBenchmarkTarget::BenchmarkCallback);
+		}
+
+		// Let every bucket fire a few times so that anything sized lazily has reached its steady state capacity
+		for (int32 Frame = 0; Frame < NumWarmupFrames; ++Frame)
+		{
+			Container.UpdateBuckets(1.0f / 60.0f);
+		}
+
+		int32 NumFires = 0;
+		int64 NumAllocations = 0;
+		{
+			FScopedAllocationCounter AllocationCounter;
+			for (int32 Frame = 0; Frame < NumMeasuredFrames; ++Frame)
+			{
+				Container.UpdateBuckets(1.0f / 60.0f);
+				NumFires += Container.LastFrameStats.NumFires;
+			}
+			NumAllocations = AllocationCounter.GetNumAllocations();
+		}
+
+		TestTrue(FString::Printf(TEXT("%s buckets fired"), ModeName), NumFires > 0);
+		TestEqual(FString::Printf(TEXT("%s allocations over %d frames"), ModeName, NumMeasuredFrames), NumAllocations, (int64)0);
+		TestEqual(FString::Printf(TEXT("%s registered entries"), ModeName), Container.NumRegisteredEntries, NumEntries);
+	}
+
+	for (UPhysicsBucketBenchmarkTarget* Target : Targets)
+	{
+		Target->RemoveFromRoot();
+	}
+
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
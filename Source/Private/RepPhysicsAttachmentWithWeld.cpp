@@ -2,18 +2,135 @@
 
 #include "RepPhysicsAttachmentWithWeld.h"
 
+#include "Components/SceneComponent.h"
+#include "Engine/NetSerialization.h"
+#include "GameFramework/Actor.h"
+#include "ReplicatedPhysicsQuantization.h"
+
 #include UE_INLINE_GENERATED_CPP_BY_NAME(RepPhysicsAttachmentWithWeld)
 
+namespace RepPhysicsAttachmentFields
+{
+	enum : uint8
+	{
+		AttachParent = 1 << 0,
+		LocationOffset = 1 << 1,
+		RotationOffset = 1 << 2,
+		RelativeScale3D = 1 << 3,
+		UniformScale = 1 << 4,
+		AttachSocket = 1 << 5,
+		AttachComponent = 1 << 6,
+
+		NumBits = 7
+	};
+
+	// Scale steps of 1/1000th
+	static constexpr uint32 ScaleQuantize = 1000;
+}
+
 bool FRepPhysicsAttachmentWithWeld::NetSerialize(FArchive& Ar, class UPackageMap* Map, bool& bOutSuccess)
 {
+	using namespace RepPhysicsAttachmentFields;
+
+	bOutSuccess = true;
+
 	// Our additional weld bit is here
 	Ar.SerializeBits(&bIsWelded, 1);
-	Ar << AttachParent;
-	LocationOffset.NetSerialize(Ar, Map, bOutSuccess);
-	RelativeScale3D.NetSerialize(Ar, Map, bOutSuccess);
-	RotationOffset.SerializeCompressedShort(Ar);
-	Ar << AttachSocket;
-	Ar << AttachComponent;
+
+	uint8 FieldMask = 0;
+	if (Ar.IsSaving())
+	{
+		// A null AttachComponent already means the parent's root component on the receiving end
+		const bool bComponentIsParentRoot = AttachParent && AttachComponent == AttachParent->GetRootComponent();
+
+		FieldMask |= AttachParent ? RepPhysicsAttachmentFields::AttachParent : 0;
+		FieldMask |= !LocationOffset.IsZero() ? RepPhysicsAttachmentFields::LocationOffset : 0;
+		FieldMask |= !RotationOffset.IsZero() ? RepPhysicsAttachmentFields::RotationOffset : 0;
+		FieldMask |= !RelativeScale3D.Equals(FVector::OneVector, 1.f / ScaleQuantize) ? RepPhysicsAttachmentFields::RelativeScale3D : 0;
+		FieldMask |= RelativeScale3D.AllComponentsEqual(1.f / ScaleQuantize) ? UniformScale : 0;
+		FieldMask |= AttachSocket != NAME_None ? RepPhysicsAttachmentFields::AttachSocket : 0;
+		FieldMask |= (AttachComponent && !bComponentIsParentRoot) ? RepPhysicsAttachmentFields::AttachComponent : 0;
+	}
+
+	Ar.SerializeBits(&FieldMask, NumBits);
+
+	if (FieldMask & RepPhysicsAttachmentFields::AttachParent)
+	{
+		Ar << AttachParent;
+	}
+	else if (Ar.IsLoading())
+	{
+		AttachParent = nullptr;
+	}
+
+	if (FieldMask & RepPhysicsAttachmentFields::LocationOffset)
+	{
+		bool bOffsetSuccess = true;
+		LocationOffset.NetSerialize(Ar, Map, bOffsetSuccess);
+		bOutSuccess &= bOffsetSuccess;
+	}
+	else if (Ar.IsLoading())
+	{
+		LocationOffset = FVector::ZeroVector;
+	}
+
+	if (FieldMask & RepPhysicsAttachmentFields::RotationOffset)
+	{
+		RotationOffset.SerializeCompressedShort(Ar);
+	}
+	else if (Ar.IsLoading())
+	{
+		RotationOffset = FRotator::ZeroRotator;
+	}
+
+	if (FieldMask & RepPhysicsAttachmentFields::RelativeScale3D)
+	{
+		if (FieldMask & UniformScale)
+		{
+			// Uniform scale is by far the common case, one packed value instead of a vector
+			uint32 Encoded = Ar.IsSaving() ? ReplicatedPhysicsQuantization::ZigZagEncode(ReplicatedPhysicsQuantization::QuantizeLocationComponent(RelativeScale3D.X, ScaleQuantize)) : 0;
+			Ar.SerializeIntPacked(Encoded);
+
+			// Saving must leave the source untouched, the quantized value is only what the other end sees
+			if (Ar.IsLoading())
+			{
+				RelativeScale3D = FVector((float)ReplicatedPhysicsQuantization::ZigZagDecode(Encoded) / ScaleQuantize);
+			}
+		}
+		else
+		{
+			FVector Scale = RelativeScale3D;
+			bOutSuccess &= SerializePackedVector<ScaleQuantize, 24>(Scale, Ar);
+			if (Ar.IsLoading())
+			{
+				RelativeScale3D = Scale;
+			}
+		}
+	}
+	else if (Ar.IsLoading())
+	{
+		RelativeScale3D = FVector::OneVector;
+	}
+
+	if (FieldMask & RepPhysicsAttachmentFields::AttachSocket)
+	{
+		Ar << AttachSocket;
+	}
+	else if (Ar.IsLoading())
+	{
+		AttachSocket = NAME_None;
+	}
+
+	if (FieldMask & RepPhysicsAttachmentFields::AttachComponent)
+	{
+		Ar << AttachComponent;
+	}
+	else if (Ar.IsLoading())
+	{
+		AttachComponent = nullptr;
+	}
+
+	bOutSuccess &= !Ar.IsError();
 	return true;
 }
 
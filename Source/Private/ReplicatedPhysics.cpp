@@ -2,8 +2,126 @@
 
 #include "ReplicatedPhysics.h"
 
+#include "Engine/NetSerialization.h"
+#include "ReplicatedPhysicsQuantization.h"
+#include "ReplicatedPhysicsStats.h"
+
 #include UE_INLINE_GENERATED_CPP_BY_NAME(ReplicatedPhysics)
 
+DECLARE_DWORD_COUNTER_STAT(TEXT("Movement Bits Serialized"), STAT_RepMovementPhysicsBits, STATGROUP_ReplicatedPhysics);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Movements Serialized"), STAT_RepMovementPhysicsCount, STATGROUP_ReplicatedPhysics);
+
+namespace ReplicatedPhysicsMovementEncoding
+{
+	using namespace ReplicatedPhysicsQuantization;
+
+	static void SerializeBitsValue(FArchive& Ar, uint32& Value, int32 NumBits)
+	{
+		if (Ar.IsLoading())
+		{
+			Value = 0;
+		}
+
+		Ar.SerializeBits(&Value, NumBits);
+	}
+
+	static void SerializeSmallestThree(FArchive& Ar, FRotator& Rotation, int32 ComponentBits, uint32& NumBits)
+	{
+		uint32 LargestIndex = 0;
+		uint32 Components[3] = {};
+
+		if (Ar.IsSaving())
+		{
+			uint8 QuantizedLargestIndex = 0;
+			QuantizeSmallestThree(Rotation, ComponentBits, QuantizedLargestIndex, Components);
+			LargestIndex = QuantizedLargestIndex;
+		}
+
+		SerializeBitsValue(Ar, LargestIndex, 2);
+		for (uint32& Component : Components)
+		{
+			SerializeBitsValue(Ar, Component, ComponentBits);
+		}
+
+		if (Ar.IsLoading())
+		{
+			Rotation = DequantizeSmallestThree((uint8)LargestIndex, Components, ComponentBits);
+		}
+
+		NumBits += 2 + 3 * ComponentBits;
+	}
+
+	// Zero vectors (sleeping or kinematic bodies) are a single bit
+	static void SerializeBoundedVector(FArchive& Ar, FVector& Vector, uint8 RangeExponent, uint32& NumBits)
+	{
+		uint8 bIsZero = Vector.IsZero() ? 1 : 0;
+		Ar.SerializeBits(&bIsZero, 1);
+		NumBits += 1;
+
+		if (bIsZero)
+		{
+			Vector = FVector::ZeroVector;
+			return;
+		}
+
+		for (int32 i = 0; i < 3; ++i)
+		{
+			uint32 Quantized = Ar.IsSaving() ? QuantizeBoundedComponent((float)Vector[i], RangeExponent) : 0;
+			SerializeBitsValue(Ar, Quantized, VelocityComponentBits);
+			Vector[i] = DequantizeBoundedComponent((uint16)Quantized, RangeExponent);
+		}
+
+		NumBits += 3 * VelocityComponentBits;
+	}
+
+	// Same packing as the Iris serializer, the size is known from the quantized components so nothing has to be written twice
+	static void SerializeLocation(FArchive& Ar, FVector& Location, EVectorQuantization QuantizationLevel, uint32& NumBits)
+	{
+		const float Scale = GetLocationScale(QuantizationLevel);
+
+		uint8 bFullPrecision = (Ar.IsSaving() && !IsLocationOnGrid(Location, Scale)) ? 1 : 0;
+		Ar.SerializeBits(&bFullPrecision, 1);
+		NumBits += 1;
+
+		if (bFullPrecision)
+		{
+			for (int32 i = 0; i < 3; ++i)
+			{
+				Ar << Location[i];
+
+				// Anything read off the wire has to be usable, the same as a non-finite value sent on the grid
+				if (Ar.IsLoading() && !FMath::IsFinite(Location[i]))
+				{
+					Location[i] = 0.0;
+				}
+			}
+
+			NumBits += 3 * 64;
+			return;
+		}
+
+		for (int32 i = 0; i < 3; ++i)
+		{
+			uint32 Encoded = Ar.IsSaving() ? ZigZagEncode(QuantizeLocationComponent(Location[i], Scale)) : 0;
+			uint32 BitCount = GetPackedIntBits(Encoded);
+			SerializeBitsValue(Ar, BitCount, PackedBitCountBits);
+			BitCount = FMath::Min(BitCount, 32u);
+
+			if (BitCount > 0)
+			{
+				SerializeBitsValue(Ar, Encoded, (int32)BitCount);
+			}
+
+			if (Ar.IsLoading())
+			{
+				Location[i] = (double)ZigZagDecode(Encoded) / Scale;
+			}
+
+			NumBits += PackedBitCountBits + BitCount;
+		}
+	}
+}
+
 FRepMovementPhysics::FRepMovementPhysics()
 {
 	LocationQuantizationLevel = EVectorQuantization::RoundTwoDecimals;
@@ -11,10 +129,9 @@ FRepMovementPhysics::FRepMovementPhysics()
 	RotationQuantizationLevel = ERotatorQuantization::ShortComponents;
 }
 
-FRepMovementPhysics::FRepMovementPhysics(FRepMovement& Other)
+FRepMovementPhysics::FRepMovementPhysics(FRepMovement& Other) :
+	FRepMovementPhysics()
 {
-	FRepMovementPhysics();
-
 	LinearVelocity = Other.LinearVelocity;
 	AngularVelocity = Other.AngularVelocity;
 	Location = Other.Location;
@@ -33,9 +150,56 @@ void FRepMovementPhysics::CopyTo(FRepMovement& Other) const
 	Other.bRepPhysics = bRepPhysics;
 }
 
+void FRepMovementPhysics::SetEncodingSettings(float MaxLinearSpeed, float MaxAngularSpeed, ERepPhysicsRotationPrecision InRotationPrecision)
+{
+	using namespace ReplicatedPhysicsMovementEncoding;
+
+	LinearVelocityRangeExponent = GetRangeExponent(MaxLinearSpeed);
+	AngularVelocityRangeExponent = GetRangeExponent(MaxAngularSpeed);
+	RotationPrecision = InRotationPrecision;
+}
+
 bool FRepMovementPhysics::NetSerialize(FArchive& Ar, UPackageMap* Map, bool& bOutSuccess)
 {
-	return FRepMovement::NetSerialize(Ar, Map, bOutSuccess);
+	using namespace ReplicatedPhysicsMovementEncoding;
+
+	uint32 NumBits = 0;
+
+	uint8 Flags = (bSimulatedPhysicSleep ? 1 : 0) | (bRepPhysics ? 2 : 0);
+	Ar.SerializeBits(&Flags, 2);
+	bSimulatedPhysicSleep = (Flags & 1) != 0;
+	bRepPhysics = (Flags & 2) != 0;
+
+	uint8 Precision = (uint8)RotationPrecision;
+	Ar.SerializeBits(&Precision, 2);
+	Ar.SerializeBits(&LinearVelocityRangeExponent, RangeExponentBits);
+	Ar.SerializeBits(&AngularVelocityRangeExponent, RangeExponentBits);
+	RotationPrecision = (ERepPhysicsRotationPrecision)FMath::Min<uint8>(Precision, (uint8)ERepPhysicsRotationPrecision::High);
+	NumBits += 4 + 2 * RangeExponentBits;
+
+	SerializeLocation(Ar, Location, LocationQuantizationLevel, NumBits);
+	SerializeSmallestThree(Ar, Rotation, GetRotationComponentBits(RotationPrecision), NumBits);
+	SerializeBoundedVector(Ar, LinearVelocity, LinearVelocityRangeExponent, NumBits);
+
+	// Without physics the angular velocity is never used on the other end
+	if (bRepPhysics)
+	{
+		SerializeBoundedVector(Ar, AngularVelocity, AngularVelocityRangeExponent, NumBits);
+	}
+	else if (Ar.IsLoading())
+	{
+		AngularVelocity = FVector::ZeroVector;
+	}
+
+	if (Ar.IsSaving())
+	{
+		INC_DWORD_STAT_BY(STAT_RepMovementPhysicsBits, NumBits);
+		INC_DWORD_STAT(STAT_RepMovementPhysicsCount);
+		CSV_CUSTOM_STAT(ReplicatedPhysics, MovementBitsSerialized, (int32)NumBits, ECsvCustomStatOp::Accumulate);
+	}
+
+	bOutSuccess = !Ar.IsError();
+	return true;
 }
 
 bool FRepMovementPhysics::GatherActorsMovement(AActor* OwningActor)
@@ -71,3 +235,240 @@ bool FRepMovementPhysics::GatherActorsMovement(AActor* OwningActor)
 
 	return true;
 }
+
+namespace ReplicatedPhysicsClientAuth
+{
+	using namespace ReplicatedPhysicsQuantization;
+
+	static constexpr float QuantizeScale = 100.0f;
+
+	// Values come from the client's simulation, so go through the saturating quantizer rather than a raw cast
+	static FIntVector QuantizeLocation(const FVector& Location)
+	{
+		return FIntVector(QuantizeLocationComponent(Location.X, QuantizeScale), QuantizeLocationComponent(Location.Y, QuantizeScale), QuantizeLocationComponent(Location.Z, QuantizeScale));
+	}
+
+	static FVector DequantizeLocation(const FIntVector& Location)
+	{
+		return FVector(Location.X, Location.Y, Location.Z) / QuantizeScale;
+	}
+
+	static FIntVector QuantizeVelocity(const FVector& Velocity, uint8 RangeExponent)
+	{
+		FIntVector Result;
+		for (int32 i = 0; i < 3; ++i)
+		{
+			Result[i] = (int32)QuantizeBoundedComponent((float)Velocity[i], RangeExponent) - VelocityComponentMax;
+		}
+
+		return Result;
+	}
+
+	// Rebuilt states come from client deltas, anything outside the range saturates
+	static FVector DequantizeVelocity(const FIntVector& Velocity, uint8 RangeExponent)
+	{
+		FVector Result;
+		for (int32 i = 0; i < 3; ++i)
+		{
+			Result[i] = DequantizeBoundedComponent((uint16)(FMath::Clamp(Velocity[i], -VelocityComponentMax, VelocityComponentMax) + VelocityComponentMax), RangeExponent);
+		}
+
+		return Result;
+	}
+
+	// Deltas come from the client, adding and subtracting them wraps around instead of overflowing
+	static int32 WrappingAdd(int32 A, int32 B)
+	{
+		return (int32)((uint32)A + (uint32)B);
+	}
+
+	static int32 WrappingSub(int32 A, int32 B)
+	{
+		return (int32)((uint32)A - (uint32)B);
+	}
+
+	static FIntVector WrappingAdd(const FIntVector& A, const FIntVector& B)
+	{
+		return FIntVector(WrappingAdd(A.X, B.X), WrappingAdd(A.Y, B.Y), WrappingAdd(A.Z, B.Z));
+	}
+
+	static FIntVector WrappingSub(const FIntVector& A, const FIntVector& B)
+	{
+		return FIntVector(WrappingSub(A.X, B.X), WrappingSub(A.Y, B.Y), WrappingSub(A.Z, B.Z));
+	}
+
+	static void SerializePackedInt(FArchive& Ar, int32& Value)
+	{
+		uint32 Encoded = ZigZagEncode(Value);
+		Ar.SerializeIntPacked(Encoded);
+		if (Ar.IsLoading())
+		{
+			Value = ZigZagDecode(Encoded);
+		}
+	}
+
+	static void SerializePackedVector(FArchive& Ar, FIntVector& Vector)
+	{
+		SerializePackedInt(Ar, Vector.X);
+		SerializePackedInt(Ar, Vector.Y);
+		SerializePackedInt(Ar, Vector.Z);
+	}
+}
+
+void FQuantizedPhysicsState::FromMovement(const FRepMovementPhysics& Movement)
+{
+	using namespace ReplicatedPhysicsClientAuth;
+
+	RotationPrecision = Movement.RotationPrecision;
+	LinearVelocityRangeExponent = Movement.LinearVelocityRangeExponent;
+	AngularVelocityRangeExponent = Movement.AngularVelocityRangeExponent;
+
+	uint32 RotationComponents[3];
+	QuantizeSmallestThree(Movement.Rotation, GetRotationComponentBits(RotationPrecision), RotationLargestIndex, RotationComponents);
+
+	Location = QuantizeLocation(Movement.Location);
+	Rotation = FIntVector((int32)RotationComponents[0], (int32)RotationComponents[1], (int32)RotationComponents[2]);
+	LinearVelocity = QuantizeVelocity(Movement.LinearVelocity, LinearVelocityRangeExponent);
+	AngularVelocity = QuantizeVelocity(Movement.AngularVelocity, AngularVelocityRangeExponent);
+	bSimulatedPhysicSleep = Movement.bSimulatedPhysicSleep;
+	bRepPhysics = Movement.bRepPhysics;
+}
+
+void FQuantizedPhysicsState::ToMovement(FRepMovementPhysics& OutMovement) const
+{
+	using namespace ReplicatedPhysicsClientAuth;
+
+	// Rebuilt states come from client deltas, keep the components on the grid before decoding them
+	const int32 ComponentBits = GetRotationComponentBits(RotationPrecision);
+	const int32 ComponentMax = (1 << ComponentBits) - 1;
+	const uint32 RotationComponents[3] = { (uint32)FMath::Clamp(Rotation.X, 0, ComponentMax), (uint32)FMath::Clamp(Rotation.Y, 0, ComponentMax), (uint32)FMath::Clamp(Rotation.Z, 0, ComponentMax) };
+
+	OutMovement.RotationPrecision = RotationPrecision;
+	OutMovement.LinearVelocityRangeExponent = LinearVelocityRangeExponent;
+	OutMovement.AngularVelocityRangeExponent = AngularVelocityRangeExponent;
+
+	OutMovement.Location = DequantizeLocation(Location);
+	OutMovement.Rotation = DequantizeSmallestThree(RotationLargestIndex & 3, RotationComponents, ComponentBits);
+	OutMovement.LinearVelocity = DequantizeVelocity(LinearVelocity, LinearVelocityRangeExponent);
+	OutMovement.AngularVelocity = DequantizeVelocity(AngularVelocity, AngularVelocityRangeExponent);
+	OutMovement.bSimulatedPhysicSleep = bSimulatedPhysicSleep;
+	OutMovement.bRepPhysics = bRepPhysics;
+}
+
+bool FQuantizedPhysicsState::HasSameEncoding(const FQuantizedPhysicsState& Other) const
+{
+	return RotationPrecision == Other.RotationPrecision
+		&& LinearVelocityRangeExponent == Other.LinearVelocityRangeExponent
+		&& AngularVelocityRangeExponent == Other.AngularVelocityRangeExponent;
+}
+
+FQuantizedPhysicsState FQuantizedPhysicsState::GetDeltaFrom(const FQuantizedPhysicsState& Baseline) const
+{
+	using namespace ReplicatedPhysicsClientAuth;
+
+	FQuantizedPhysicsState Delta = *this;
+	Delta.Location = WrappingSub(Location, Baseline.Location);
+	Delta.Rotation = WrappingSub(Rotation, Baseline.Rotation);
+	Delta.LinearVelocity = WrappingSub(LinearVelocity, Baseline.LinearVelocity);
+	Delta.AngularVelocity = WrappingSub(AngularVelocity, Baseline.AngularVelocity);
+	return Delta;
+}
+
+FQuantizedPhysicsState FQuantizedPhysicsState::AddDelta(const FQuantizedPhysicsState& Delta) const
+{
+	using namespace ReplicatedPhysicsClientAuth;
+
+	// The encoding settings stay the baseline's, deltas don't carry them
+	FQuantizedPhysicsState Result = *this;
+	Result.Location = WrappingAdd(Location, Delta.Location);
+	Result.Rotation = WrappingAdd(Rotation, Delta.Rotation);
+	Result.LinearVelocity = WrappingAdd(LinearVelocity, Delta.LinearVelocity);
+	Result.AngularVelocity = WrappingAdd(AngularVelocity, Delta.AngularVelocity);
+	Result.RotationLargestIndex = Delta.RotationLargestIndex & 3;
+	Result.bSimulatedPhysicSleep = Delta.bSimulatedPhysicSleep;
+	Result.bRepPhysics = Delta.bRepPhysics;
+	return Result;
+}
+
+void FClientAuthStateHistory::Reset()
+{
+	for (int32 i = 0; i < Capacity; ++i)
+	{
+		bIsValid[i] = false;
+	}
+}
+
+void FClientAuthStateHistory::Store(uint16 Sequence, const FQuantizedPhysicsState& State)
+{
+	const int32 Slot = Sequence % Capacity;
+	States[Slot] = State;
+	Sequences[Slot] = Sequence;
+	bIsValid[Slot] = true;
+}
+
+const FQuantizedPhysicsState* FClientAuthStateHistory::Find(uint16 Sequence) const
+{
+	const int32 Slot = Sequence % Capacity;
+	return (bIsValid[Slot] && Sequences[Slot] == Sequence) ? &States[Slot] : nullptr;
+}
+
+bool FRepClientAuthMovement::NetSerialize(FArchive& Ar, UPackageMap* Map, bool& bOutSuccess)
+{
+	using namespace ReplicatedPhysicsClientAuth;
+
+	uint8 Flags = (bIsFullState ? 1 : 0) | (State.bSimulatedPhysicSleep ? 2 : 0) | (State.bRepPhysics ? 4 : 0);
+	Ar.SerializeBits(&Flags, 3);
+	bIsFullState = (Flags & 1) != 0;
+	State.bSimulatedPhysicSleep = (Flags & 2) != 0;
+	State.bRepPhysics = (Flags & 4) != 0;
+
+	// The dropped component can change between any two states, so it is always sent rather than delta encoded
+	uint8 LargestIndex = Ar.IsLoading() ? 0 : State.RotationLargestIndex;
+	Ar.SerializeBits(&LargestIndex, 2);
+	State.RotationLargestIndex = LargestIndex & 3;
+
+	if (bIsFullState)
+	{
+		uint8 Precision = Ar.IsLoading() ? 0 : (uint8)State.RotationPrecision;
+		uint8 LinearRangeExponent = Ar.IsLoading() ? 0 : State.LinearVelocityRangeExponent;
+		uint8 AngularRangeExponent = Ar.IsLoading() ? 0 : State.AngularVelocityRangeExponent;
+		Ar.SerializeBits(&Precision, 2);
+		Ar.SerializeBits(&LinearRangeExponent, RangeExponentBits);
+		Ar.SerializeBits(&AngularRangeExponent, RangeExponentBits);
+		State.RotationPrecision = (ERepPhysicsRotationPrecision)FMath::Min<uint8>(Precision, (uint8)ERepPhysicsRotationPrecision::High);
+		State.LinearVelocityRangeExponent = LinearRangeExponent & ((1 << RangeExponentBits) - 1);
+		State.AngularVelocityRangeExponent = AngularRangeExponent & ((1 << RangeExponentBits) - 1);
+	}
+
+	Ar << Sequence;
+	if (!bIsFullState)
+	{
+		// The baseline is always a recent ack, so the distance back to it packs into a byte or less
+		uint32 BaselineAge = (uint16)(Sequence - BaselineSequence);
+		Ar.SerializeIntPacked(BaselineAge);
+		BaselineSequence = (uint16)(Sequence - BaselineAge);
+	}
+
+	// Vectors that are all zero (unchanged in a delta) are skipped entirely
+	uint8 VectorMask = (State.Location != FIntVector::ZeroValue ? 1 : 0)
+		| (State.Rotation != FIntVector::ZeroValue ? 2 : 0)
+		| (State.LinearVelocity != FIntVector::ZeroValue ? 4 : 0)
+		| (State.AngularVelocity != FIntVector::ZeroValue ? 8 : 0);
+	Ar.SerializeBits(&VectorMask, 4);
+
+	FIntVector* Vectors[] = { &State.Location, &State.Rotation, &State.LinearVelocity, &State.AngularVelocity };
+	for (int32 i = 0; i < UE_ARRAY_COUNT(Vectors); ++i)
+	{
+		if (VectorMask & (1 << i))
+		{
+			SerializePackedVector(Ar, *Vectors[i]);
+		}
+		else if (Ar.IsLoading())
+		{
+			*Vectors[i] = FIntVector::ZeroValue;
+		}
+	}
+
+	bOutSuccess = !Ar.IsError();
+	return true;
+}
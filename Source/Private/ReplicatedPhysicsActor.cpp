@@ -2,14 +2,28 @@
 
 #include "ReplicatedPhysicsActor.h"
 
+#include "Engine/NetConnection.h"
+#include "GameFramework/GameStateBase.h"
+#include "GameFramework/Pawn.h"
 #include "GameFramework/PlayerState.h"
 #include "PhysicsBucketUpdateSubsystem.h"
+#include "ReplicatedPhysicsClientAuthComponent.h"
 #include "Net/UnrealNetwork.h"
 #include "Net/Core/PushModel/PushModel.h"
 #include "Physics/Experimental/PhysScene_Chaos.h"
+#include "PhysicsEngine/PhysicsSettings.h"
 
 #include UE_INLINE_GENERATED_CPP_BY_NAME(ReplicatedPhysicsActor)
 
+namespace ReplicatedPhysicsHandback
+{
+	static int32 GetServerPhysicsFrame(const UWorld* World)
+	{
+		const FPhysScene_Chaos* Scene = World ? static_cast<const FPhysScene_Chaos*>(World->GetPhysicsScene()) : nullptr;
+		return (Scene && Scene->GetSolver()) ? Scene->GetSolver()->GetCurrentFrame() : INDEX_NONE;
+	}
+}
+
 AReplicatedPhysicsActor::AReplicatedPhysicsActor()
 {
 	if (RootComponent)
@@ -40,6 +54,10 @@ void AReplicatedPhysicsActor::GetLifetimeReplicatedProps(TArray<FLifetimePropert
 	DOREPLIFETIME_WITH_PARAMS_FAST(ThisClass, bAllowIgnoringAttachOnOwner, PushModelParams);
 	DOREPLIFETIME_WITH_PARAMS_FAST(ThisClass, ClientAuthReplicationData, PushModelParams);
 
+	FDoRepLifetimeParams OwnerOnlyParams{COND_OwnerOnly, REPNOTIFY_OnChanged, /*bIsPushBased=*/true};
+	DOREPLIFETIME_WITH_PARAMS_FAST(ThisClass, ClientAuthAckSequence, OwnerOnlyParams);
+	DOREPLIFETIME_WITH_PARAMS_FAST(ThisClass, ClientAuthHandback, OwnerOnlyParams);
+
 	FDoRepLifetimeParams AttachmentReplicationParams{COND_Custom, REPNOTIFY_Always, /*bIsPushBased=*/true};
 	DOREPLIFETIME_WITH_PARAMS_FAST(ThisClass, AttachmentWeldReplication, AttachmentReplicationParams);
 }
@@ -48,6 +66,20 @@ void AReplicatedPhysicsActor::GatherCurrentMovement()
 {
 	if (IsReplicatingMovement() || (RootComponent && RootComponent->GetAttachParent()))
 	{
+		UPrimitiveComponent* RootPrimComp = Cast<UPrimitiveComponent>(GetRootComponent());
+		const bool bIsInHandbackWindow = HasAuthority() && GetWorld()->GetTimeSeconds() <= ClientAuthHandbackWindowEndTime;
+
+		UPhysicsBucketUpdateSubsystem* BucketSubsystem = PhysicsStateGatherSlot != INDEX_NONE ? GetWorld()->GetSubsystem<UPhysicsBucketUpdateSubsystem>() : nullptr;
+		FGatheredPhysicsState GatheredState;
+		const bool bHasGatheredState = BucketSubsystem && BucketSubsystem->GetGatheredPhysicsState(PhysicsStateGatherSlot, RootPrimComp, GatheredState);
+
+		// Free bodies that the bulk gather found within their thresholds keep what was last sent, nothing else to look at
+		if (bHasGatheredState && !GatheredState.bChanged && bHasDirtiedMovement && LastDirtiedMovement.bRepPhysics && !bIsInHandbackWindow &&
+			!RootPrimComp->IsWelded() && !RootPrimComp->GetAttachParent())
+		{
+			return;
+		}
+
 		bool bWasAttachmentModified = false;
 		bool bWasRepMovementModified = false;
 
@@ -58,8 +90,8 @@ void AReplicatedPhysicsActor::GatherCurrentMovement()
 		AttachmentWeldReplication.AttachComponent = nullptr;
 
 		FRepMovement& RepMovement = GetReplicatedMovement_Mutable();
+		int32 MovementFrame = INDEX_NONE;
 
-		UPrimitiveComponent* RootPrimComp = Cast<UPrimitiveComponent>(GetRootComponent());
 		if (RootPrimComp && RootPrimComp->IsSimulatingPhysics())
 		{
 #if UE_WITH_IRIS
@@ -70,11 +102,19 @@ void AReplicatedPhysicsActor::GatherCurrentMovement()
 
 			UWorld* World = GetWorld();
 			int ServerFrame = 0;
-			if (FPhysScene_Chaos* Scene = static_cast<FPhysScene_Chaos*>(World->GetPhysicsScene()))
+			if (bHasGatheredState)
+			{
+				// Already read this frame by the bulk gather
+				RepMovement.FillFrom(GatheredState.State, this, GatheredState.CacheFrame);
+				MovementFrame = GatheredState.PhysicsFrame;
+				bFoundInCache = true;
+			}
+			else if (FPhysScene_Chaos* Scene = static_cast<FPhysScene_Chaos*>(World->GetPhysicsScene()))
 			{
 				if (const FRigidBodyState* FoundState = Scene->GetStateFromReplicationCache(RootPrimComp, ServerFrame))
 				{
 					RepMovement.FillFrom(*FoundState, this, Scene->ReplicationCache.ServerFrame);
+					MovementFrame = Scene->ReplicationCache.ServerFrame;
 					bFoundInCache = true;
 				}
 			}
@@ -85,6 +125,7 @@ void AReplicatedPhysicsActor::GatherCurrentMovement()
 				FRigidBodyState RBState;
 				RootPrimComp->GetRigidBodyState(RBState);
 				RepMovement.FillFrom(RBState, this, 0);
+				MovementFrame = ReplicatedPhysicsHandback::GetServerPhysicsFrame(World);
 			}
 
 			// Don't replicate movement if we're welded to another parent actor.
@@ -158,6 +199,57 @@ void AReplicatedPhysicsActor::GatherCurrentMovement()
 
 			bWasRepMovementModified = (bWasRepMovementModified || RepMovement.bRepPhysics);
 			RepMovement.bRepPhysics = false;
+			MovementFrame = ReplicatedPhysicsHandback::GetServerPhysicsFrame(GetWorld());
+		}
+
+		// Resting or barely moving bodies keep what was last sent so that push model has nothing to compare or send
+		// The handback window always sends, the owner waits on a movement frame from after the handback
+		// The bulk gather already compared the body against what was last sent, unless its physics flag flipped
+		const bool bUseGatheredChange = bHasGatheredState && RepMovement.bRepPhysics == LastDirtiedMovement.bRepPhysics;
+		if (bWasRepMovementModified && bHasDirtiedMovement && !bIsInHandbackWindow &&
+			(bUseGatheredChange ? !GatheredState.bChanged : !HasMovementChangedSinceLastDirty(RepMovement)))
+		{
+			RepMovement = LastDirtiedMovement;
+			bWasRepMovementModified = false;
+		}
+		else if (bWasRepMovementModified)
+		{
+			LastDirtiedMovement = RepMovement;
+			bHasDirtiedMovement = true;
+
+			if (bHasGatheredState)
+			{
+				BucketSubsystem->MarkGatheredPhysicsStateSent(PhysicsStateGatherSlot);
+			}
+
+			// A body that just went to sleep can stop replicating once this rest state is out
+			if (RepMovement.bSimulatedPhysicSleep && bUseSleepDormancy && HasAuthority())
+			{
+				if (UPhysicsBucketUpdateSubsystem* Subsystem = GetWorld()->GetSubsystem<UPhysicsBucketUpdateSubsystem>())
+				{
+					SleepDormancyHandle = Subsystem->AddOneShotTimer(SleepDormancyDelay, this, &ThisClass::TryEnterSleepDormancy, GET_FUNCTION_NAME_CHECKED(ThisClass, TryEnterSleepDormancy));
+				}
+			}
+		}
+
+		if (bWasAttachmentModified && bHasDirtiedAttachment && !HasAttachmentChangedSinceLastDirty())
+		{
+			AttachmentWeldReplication = LastDirtiedAttachment;
+			bWasAttachmentModified = false;
+		}
+		else if (bWasAttachmentModified)
+		{
+			LastDirtiedAttachment = AttachmentWeldReplication;
+			bHasDirtiedAttachment = true;
+		}
+
+		// The owner releases its block after a session once the movement it gets is from at or after the handback
+		if (bWasRepMovementModified && bIsInHandbackWindow && ClientAuthHandback.MovementFrame != MovementFrame)
+		{
+			ClientAuthHandback.MovementFrame = MovementFrame;
+#if WITH_PUSH_MODEL
+			MARK_PROPERTY_DIRTY_FROM_NAME(ThisClass, ClientAuthHandback, this);
+#endif
 		}
 #if WITH_PUSH_MODEL
 		if (bWasRepMovementModified)
@@ -175,6 +267,39 @@ void AReplicatedPhysicsActor::GatherCurrentMovement()
 	}
 }
 
+bool AReplicatedPhysicsActor::HasMovementChangedSinceLastDirty(const FRepMovement& Movement) const
+{
+	const FRepMovement& Last = LastDirtiedMovement;
+
+	// Flags and coming to a stop always go out so that the other end settles on the exact resting state
+	if (Movement.bRepPhysics != Last.bRepPhysics || Movement.bSimulatedPhysicSleep != Last.bSimulatedPhysicSleep ||
+		Movement.LinearVelocity.IsZero() != Last.LinearVelocity.IsZero() || Movement.AngularVelocity.IsZero() != Last.AngularVelocity.IsZero())
+	{
+		return true;
+	}
+
+	return FVector::DistSquared(Movement.Location, Last.Location) > FMath::Square(MovementLocationThreshold) ||
+		!Movement.Rotation.Equals(Last.Rotation, MovementRotationThreshold) ||
+		FVector::DistSquared(Movement.LinearVelocity, Last.LinearVelocity) > FMath::Square(MovementVelocityThreshold) ||
+		FVector::DistSquared(Movement.AngularVelocity, Last.AngularVelocity) > FMath::Square(MovementVelocityThreshold);
+}
+
+bool AReplicatedPhysicsActor::HasAttachmentChangedSinceLastDirty() const
+{
+	const FRepPhysicsAttachmentWithWeld& Current = AttachmentWeldReplication;
+	const FRepPhysicsAttachmentWithWeld& Last = LastDirtiedAttachment;
+
+	if (Current.AttachParent != Last.AttachParent || Current.AttachComponent != Last.AttachComponent ||
+		Current.AttachSocket != Last.AttachSocket || Current.bIsWelded != Last.bIsWelded)
+	{
+		return true;
+	}
+
+	return FVector::DistSquared(Current.LocationOffset, Last.LocationOffset) > FMath::Square(MovementLocationThreshold) ||
+		!Current.RotationOffset.Equals(Last.RotationOffset, MovementRotationThreshold) ||
+		!Current.RelativeScale3D.Equals(Last.RelativeScale3D, UE_KINDA_SMALL_NUMBER);
+}
+
 void AReplicatedPhysicsActor::PreReplication(IRepChangedPropertyTracker& ChangedPropertyTracker)
 {
 #if WITH_PUSH_MODEL
@@ -205,9 +330,143 @@ void AReplicatedPhysicsActor::PreReplication(IRepChangedPropertyTracker& Changed
 #endif
 }
 
+void AReplicatedPhysicsActor::BeginPlay()
+{
+	// Both ends have to agree on the mode, the server replicates its physics frame with the movement for it
+	if (IsUsingResimulation())
+	{
+		SetPhysicsReplicationMode(EPhysicsReplicationMode::Resimulation);
+	}
+
+	Super::BeginPlay();
+
+	// The server reads every registered body in one pass per frame instead of each actor looking itself up in GatherCurrentMovement
+	UPrimitiveComponent* RootPrimComp = Cast<UPrimitiveComponent>(GetRootComponent());
+	UPhysicsBucketUpdateSubsystem* BucketSubsystem = GetWorld()->GetSubsystem<UPhysicsBucketUpdateSubsystem>();
+	if (HasAuthority() && RootPrimComp && BucketSubsystem)
+	{
+		PhysicsStateGatherSlot = BucketSubsystem->RegisterPhysicsStateGather(RootPrimComp, MovementLocationThreshold, MovementRotationThreshold, MovementVelocityThreshold);
+	}
+
+	if (HasAuthority() && RootPrimComp && bUseSleepDormancy)
+	{
+		// Chaos only reports wakes for bodies that ask for them
+		RootPrimComp->BodyInstance.bGenerateWakeEvents = true;
+		RootPrimComp->OnComponentWake.AddDynamic(this, &ThisClass::OnRootComponentWake);
+	}
+}
+
+void AReplicatedPhysicsActor::TryEnterSleepDormancy()
+{
+	SleepDormancyHandle.Invalidate();
+
+	// Leave designer set dormancy alone, we only ever move between awake and our own dormant state
+	UPrimitiveComponent* RootPrimComp = Cast<UPrimitiveComponent>(GetRootComponent());
+	if (!HasAuthority() || !bUseSleepDormancy || bIsSleepDormant || NetDormancy != DORM_Awake || !RootPrimComp || !RootPrimComp->IsSimulatingPhysics() || RootPrimComp->IsAnyRigidBodyAwake())
+		return;
+
+	// Woken and put back to sleep since, the newer rest state re-arms us once it is sent
+	if (!bHasDirtiedMovement || !LastDirtiedMovement.bSimulatedPhysicSleep)
+		return;
+
+	UWorld* World = GetWorld();
+	UPhysicsBucketUpdateSubsystem* BucketSubsystem = World ? World->GetSubsystem<UPhysicsBucketUpdateSubsystem>() : nullptr;
+	if (!BucketSubsystem)
+		return;
+
+	// An owner without the batching component starts its sessions through our own RPCs, which a closed channel never delivers
+	// Batched RPCs go through the always open controller channel and wake us once the movement is queued
+	const bool bOwnerNeedsOpenChannel = GetNetConnection() != nullptr && UReplicatedPhysicsClientAuthComponent::FindOwningComponent(this) == nullptr;
+
+	// Still in the middle of a client auth session or its handback, or owned as above, try again later
+	if (bOwnerNeedsOpenChannel || ClientAuthReplicationData.bIsCurrentlyClientAuth || bHasPendingClientAuthMovement || World->GetTimeSeconds() <= ClientAuthHandbackWindowEndTime)
+	{
+		SleepDormancyHandle = BucketSubsystem->AddOneShotTimer(FMath::Max(SleepDormancyDelay, 0.1f), this, &ThisClass::TryEnterSleepDormancy, GET_FUNCTION_NAME_CHECKED(ThisClass, TryEnterSleepDormancy));
+		return;
+	}
+
+	bIsSleepDormant = true;
+	RootTransformUpdatedHandle = RootPrimComp->TransformUpdated.AddUObject(this, &ThisClass::OnRootTransformUpdated);
+	BucketSubsystem->SetPhysicsStateGatherPaused(PhysicsStateGatherSlot, true);
+
+	// The engine sends whatever is still unacked before it closes the channels
+	SetNetDormancy(DORM_DormantAll);
+}
+
+void AReplicatedPhysicsActor::WakeFromSleepDormancy()
+{
+	UWorld* World = GetWorld();
+	UPhysicsBucketUpdateSubsystem* BucketSubsystem = World ? World->GetSubsystem<UPhysicsBucketUpdateSubsystem>() : nullptr;
+
+	if (SleepDormancyHandle.IsValid() && BucketSubsystem)
+	{
+		BucketSubsystem->RemoveBucketEntry(SleepDormancyHandle);
+	}
+
+	if (!bIsSleepDormant)
+		return;
+
+	bIsSleepDormant = false;
+
+	if (USceneComponent* Root = GetRootComponent())
+	{
+		Root->TransformUpdated.Remove(RootTransformUpdatedHandle);
+	}
+
+	RootTransformUpdatedHandle.Reset();
+
+	if (BucketSubsystem)
+	{
+		BucketSubsystem->SetPhysicsStateGatherPaused(PhysicsStateGatherSlot, false);
+	}
+
+	SetNetDormancy(DORM_Awake);
+}
+
+void AReplicatedPhysicsActor::OnRootComponentWake(UPrimitiveComponent* WakingComponent, FName BoneName)
+{
+	WakeFromSleepDormancy();
+}
+
+void AReplicatedPhysicsActor::OnRootTransformUpdated(USceneComponent* UpdatedComponent, EUpdateTransformFlags UpdateTransformFlags, ETeleportType Teleport)
+{
+	WakeFromSleepDormancy();
+}
+
+void AReplicatedPhysicsActor::SetOwner(AActor* NewOwner)
+{
+	// Client auth needs an owning connection, and the owner's RPCs need an open channel to reach us
+	if (NewOwner != GetOwner())
+	{
+		WakeFromSleepDormancy();
+	}
+
+	const UNetConnection* PreviousConnection = GetNetConnection();
+	Super::SetOwner(NewOwner);
+
+	// The new owning client starts its sequence over
+	if (HasAuthority() && GetNetConnection() != PreviousConnection)
+	{
+		ResetClientAuthReceiveState();
+	}
+}
+
+bool AReplicatedPhysicsActor::IsUsingResimulation() const
+{
+	return ClientAuthReplicationData.bUseResimulation && UPhysicsSettings::Get()->PhysicsPrediction.bEnablePhysicsPrediction;
+}
+
+bool AReplicatedPhysicsActor::IsBlockingServerMovement() const
+{
+	if (!bAllowIgnoringAttachOnOwner)
+		return false;
+
+	return (ClientAuthReplicationData.bIsCurrentlyClientAuth && !IsUsingResimulation()) || ShouldSkipAttachmentReplication();
+}
+
 void AReplicatedPhysicsActor::PostNetReceivePhysicState()
 {
-	if (bAllowIgnoringAttachOnOwner && (ClientAuthReplicationData.bIsCurrentlyClientAuth || ShouldSkipAttachmentReplication()))
+	if (IsBlockingServerMovement())
 	{
 		return;
 	}
@@ -217,7 +476,9 @@ void AReplicatedPhysicsActor::PostNetReceivePhysicState()
 
 void AReplicatedPhysicsActor::OnRep_ReplicatedMovement()
 {
-	if (bAllowIgnoringAttachOnOwner && (ClientAuthReplicationData.bIsCurrentlyClientAuth || ShouldSkipAttachmentReplication()))
+	TryCompleteClientAuthHandback();
+
+	if (IsBlockingServerMovement())
 	{
 		return;
 	}
@@ -227,7 +488,7 @@ void AReplicatedPhysicsActor::OnRep_ReplicatedMovement()
 
 void AReplicatedPhysicsActor::OnRep_ReplicateMovement()
 {
-	if (bAllowIgnoringAttachOnOwner && (ClientAuthReplicationData.bIsCurrentlyClientAuth || ShouldSkipAttachmentReplication()))
+	if (IsBlockingServerMovement())
 	{
 		return;
 	}
@@ -308,13 +569,61 @@ void AReplicatedPhysicsActor::EndPlay(const EEndPlayReason::Type EndPlayReason)
 {
 	RemoveFromClientReplicationBucket();
 
+	if (bIsSleepDormant)
+	{
+		if (USceneComponent* Root = GetRootComponent())
+		{
+			Root->TransformUpdated.Remove(RootTransformUpdatedHandle);
+		}
+
+		bIsSleepDormant = false;
+	}
+
+	if (PhysicsStateGatherSlot != INDEX_NONE)
+	{
+		if (UPhysicsBucketUpdateSubsystem* BucketSubsystem = GetWorld()->GetSubsystem<UPhysicsBucketUpdateSubsystem>())
+		{
+			BucketSubsystem->UnregisterPhysicsStateGather(PhysicsStateGatherSlot);
+		}
+	}
+
 	Super::EndPlay(EndPlayReason);
 }
 
 bool AReplicatedPhysicsActor::AddToClientReplicationBucket()
 {
-	// The subsystem automatically removes entries with the same function signature, so it's safe to just always add here
-	GetWorld()->GetSubsystem<UPhysicsBucketUpdateSubsystem>()->AddObjectToBucket(ClientAuthReplicationData.UpdateRate, this, FName("PollReplicationEvent"));
+	ClientAuthBatcher = UReplicatedPhysicsClientAuthComponent::FindForActor(this);
+
+	// The poll samples the root body from the per frame gather, a listen server's slot may be paused by sleep dormancy
+	ClientAuthGatherSubsystem = GetWorld()->GetSubsystem<UPhysicsBucketUpdateSubsystem>();
+	UPrimitiveComponent* RootPrimComp = Cast<UPrimitiveComponent>(GetRootComponent());
+	if (HasAuthority())
+	{
+		WakeFromSleepDormancy();
+	}
+	else if (PhysicsStateGatherSlot == INDEX_NONE && RootPrimComp && ClientAuthGatherSubsystem)
+	{
+		PhysicsStateGatherSlot = ClientAuthGatherSubsystem->RegisterPhysicsStateGather(RootPrimComp, MovementLocationThreshold, MovementRotationThreshold, MovementVelocityThreshold);
+	}
+
+	ClientAuthReplicationData.bHasSentMovement = false;
+
+	// A new throw before the last one was handed back, its pending release would cut this session short
+	ClientAuthReplicationData.bIsAwaitingHandback = false;
+	if (ClientAuthReplicationData.ResetReplicationHandle.IsValid())
+	{
+		if (const auto World = GetWorld())
+		{
+			World->GetSubsystem<UPhysicsBucketUpdateSubsystem>()->RemoveBucketEntry(ClientAuthReplicationData.ResetReplicationHandle);
+		}
+	}
+
+	// Acks from an earlier session refer to states the server has already thrown away
+	ClientAuthReplicationData.SessionFirstSequence = ClientAuthReplicationData.NextSendSequence;
+	ClientAuthReplicationData.SentStates.Reset();
+
+	// Adaptive sessions start at their max rate, they are thrown so they are about to move fast
+	RegisterClientAuthPoll(ClientAuthReplicationData.bUseAdaptiveUpdateRate ? ClientAuthReplicationData.MaxAdaptiveUpdateRate : ClientAuthReplicationData.UpdateRate);
 	ClientAuthReplicationData.bIsCurrentlyClientAuth = true;
 
 	if (const auto World = GetWorld())
@@ -325,11 +634,132 @@ bool AReplicatedPhysicsActor::AddToClientReplicationBucket()
 	return true;
 }
 
+void AReplicatedPhysicsActor::RegisterClientAuthPoll(int32 NewUpdateRate)
+{
+	// The subsystem automatically removes entries with the same function signature, so it's safe to just always add here
+	// This is also safe from inside the poll itself, the bucket defers the swap until it is done firing
+	// The gather stage samples the body from the subsystem's snapshot, the poll then acts on it on the game thread
+	ClientAuthReplicationData.PollBucketHandle = GetWorld()->GetSubsystem<UPhysicsBucketUpdateSubsystem>()->AddReplicatingObject(NewUpdateRate, this, &ThisClass::PollReplicationEvent, &ThisClass::GatherClientAuthState, GET_FUNCTION_NAME_CHECKED(ThisClass, PollReplicationEvent), ClientAuthReplicationData.UpdatePriority);
+	ClientAuthReplicationData.CurrentUpdateRate = NewUpdateRate;
+}
+
+int32 AReplicatedPhysicsActor::GetAdaptiveUpdateRate() const
+{
+	const FPhysicsClientAuthReplicationData& ClientAuthData = ClientAuthReplicationData;
+	const int32 MinRate = FMath::Clamp(ClientAuthData.MinAdaptiveUpdateRate, 1, 100);
+	const int32 MaxRate = FMath::Clamp(ClientAuthData.MaxAdaptiveUpdateRate, MinRate, 100);
+
+	// 0 means the min rate is enough, 1 means the max rate is needed, the strongest reason wins
+	float Demand = 0.f;
+
+	if (ClientAuthData.bGatheredMovementValid)
+	{
+		Demand = FMath::Max(Demand, ClientAuthData.GatheredMovement.LinearVelocity.Size() / FMath::Max(ClientAuthData.AdaptiveMaxRateLinearSpeed, 1.f));
+		Demand = FMath::Max(Demand, ClientAuthData.GatheredMovement.AngularVelocity.Size() / FMath::Max(ClientAuthData.AdaptiveMaxRateAngularSpeed, 1.f));
+	}
+
+	const UWorld* World = GetWorld();
+	if (World && ClientAuthData.LastContactTime >= 0.f && (World->GetTimeSeconds() - ClientAuthData.LastContactTime) <= ClientAuthData.AdaptiveContactBoostTime)
+	{
+		Demand = 1.f;
+	}
+
+	if (Demand < 1.f && World && ClientAuthData.AdaptiveFarPlayerDistance > 0.f)
+	{
+		if (const AGameStateBase* GameState = World->GetGameState())
+		{
+			const FVector Location = GetActorLocation();
+			float ClosestDistSq = FMath::Square(ClientAuthData.AdaptiveFarPlayerDistance);
+			for (const APlayerState* PlayerState : GameState->PlayerArray)
+			{
+				// Our own pawn is the one throwing, only other players care about the precision
+				const APawn* Pawn = PlayerState ? PlayerState->GetPawn() : nullptr;
+				if (Pawn && !Pawn->IsLocallyControlled())
+				{
+					ClosestDistSq = FMath::Min(ClosestDistSq, FVector::DistSquared(Pawn->GetActorLocation(), Location));
+				}
+			}
+
+			const float FalloffRange = FMath::Max(ClientAuthData.AdaptiveFarPlayerDistance - ClientAuthData.AdaptiveNearPlayerDistance, 1.f);
+			Demand = FMath::Max(Demand, 1.f - FMath::Clamp((FMath::Sqrt(ClosestDistSq) - ClientAuthData.AdaptiveNearPlayerDistance) / FalloffRange, 0.f, 1.f));
+		}
+	}
+
+	const float WantedRate = FMath::Lerp((float)MinRate, (float)MaxRate, FMath::Clamp(Demand, 0.f, 1.f));
+	const int32 RateStep = FMath::Max(ClientAuthData.AdaptiveRateStep, 1);
+	return FMath::Clamp(FMath::CeilToInt32(WantedRate / RateStep) * RateStep, MinRate, MaxRate);
+}
+
+void AReplicatedPhysicsActor::UpdateAdaptiveUpdateRate()
+{
+	const int32 WantedRate = GetAdaptiveUpdateRate();
+	const int32 CurrentRate = ClientAuthReplicationData.CurrentUpdateRate;
+
+	// Go up right away as precision is needed now, only come down once it is clearly not needed anymore
+	const bool bRaise = WantedRate > CurrentRate;
+	const bool bLower = WantedRate < CurrentRate * (1.f - FMath::Clamp(ClientAuthReplicationData.AdaptiveRateHysteresis, 0.f, 1.f));
+	if (bRaise || bLower)
+	{
+		RegisterClientAuthPoll(WantedRate);
+	}
+}
+
+bool AReplicatedPhysicsActor::ShouldSendClientAuthMovement(const FRepMovementPhysics& NewMovement) const
+{
+	const FPhysicsClientAuthReplicationData& ClientAuthData = ClientAuthReplicationData;
+	const UWorld* World = GetWorld();
+	if (!ClientAuthData.bHasSentMovement || !World)
+		return true;
+
+	const float TimeSinceSend = World->GetTimeSeconds() - ClientAuthData.LastSentTime;
+	if (TimeSinceSend >= 1.f / FMath::Max(ClientAuthData.ErrorGateKeepAliveRate, 0.1f))
+		return true;
+
+	// Extrapolate the last send the way the server's simulation carries it forward, ballistic when gravity applies
+	const FRepMovementPhysics& LastSent = ClientAuthData.LastSentMovement;
+	const UPrimitiveComponent* PrimitiveComponent = Cast<UPrimitiveComponent>(GetRootComponent());
+	const FVector Gravity = (PrimitiveComponent && PrimitiveComponent->IsGravityEnabled()) ? FVector(0.f, 0.f, World->GetGravityZ()) : FVector::ZeroVector;
+
+	const FVector PredictedLocation = LastSent.Location + LastSent.LinearVelocity * TimeSinceSend + 0.5f * Gravity * FMath::Square(TimeSinceSend);
+	if (FVector::DistSquared(NewMovement.Location, PredictedLocation) > FMath::Square(ClientAuthData.ErrorGateLocationThreshold))
+		return true;
+
+	const FVector PredictedVelocity = LastSent.LinearVelocity + Gravity * TimeSinceSend;
+	if (FVector::DistSquared(NewMovement.LinearVelocity, PredictedVelocity) > FMath::Square(ClientAuthData.ErrorGateVelocityThreshold))
+		return true;
+
+	// Angular velocity is replicated in degrees per second around world axes
+	FQuat PredictedRotation = LastSent.Rotation.Quaternion();
+	const FVector AngularVelocityRad = FMath::DegreesToRadians(LastSent.AngularVelocity);
+	const float AngularSpeed = AngularVelocityRad.Size();
+	if (AngularSpeed > UE_KINDA_SMALL_NUMBER)
+	{
+		PredictedRotation = FQuat(AngularVelocityRad / AngularSpeed, AngularSpeed * TimeSinceSend) * PredictedRotation;
+	}
+
+	return FMath::RadiansToDegrees(NewMovement.Rotation.Quaternion().AngularDistance(PredictedRotation)) > ClientAuthData.ErrorGateRotationThreshold;
+}
+
+void AReplicatedPhysicsActor::NotifyHit(UPrimitiveComponent* MyComp, AActor* Other, UPrimitiveComponent* OtherComp, bool bSelfMoved, FVector HitLocation, FVector HitNormal, FVector NormalImpulse, const FHitResult& Hit)
+{
+	Super::NotifyHit(MyComp, Other, OtherComp, bSelfMoved, HitLocation, HitNormal, NormalImpulse, Hit);
+
+	if (HasAuthority())
+	{
+		WakeFromSleepDormancy();
+	}
+
+	if (const UWorld* World = GetWorld())
+	{
+		ClientAuthReplicationData.LastContactTime = World->GetTimeSeconds();
+	}
+}
+
 bool AReplicatedPhysicsActor::RemoveFromClientReplicationBucket()
 {
 	if (ClientAuthReplicationData.bIsCurrentlyClientAuth)
 	{
-		GetWorld()->GetSubsystem<UPhysicsBucketUpdateSubsystem>()->RemoveObjectFromBucketByFunctionName(this, FName(TEXT("PollReplicationEvent")));
+		GetWorld()->GetSubsystem<UPhysicsBucketUpdateSubsystem>()->RemoveBucketEntry(ClientAuthReplicationData.PollBucketHandle);
 		CeaseReplicationBlocking();
 		return true;
 	}
@@ -346,39 +776,49 @@ bool AReplicatedPhysicsActor::PollReplicationEvent()
 	if (!World) return false; // Tell the bucket subsystem to remove us from consideration
 
 	bool bRemoveBlocking = false;
+	const bool bUseResimulation = IsUsingResimulation();
 
-	if ((World->GetTimeSeconds() - ClientAuthReplicationData.TimeAtInitialThrow) > 10.0f)
+	// Resimulation already pulls us back to the server when it disagrees, so there is nothing to time out
+	if (!bUseResimulation && (World->GetTimeSeconds() - ClientAuthReplicationData.TimeAtInitialThrow) > 10.0f)
 	{
 		// Time out the sending. It's been 10 seconds since we threw the object, so it's likely conflicting with some other
 		// server Authed movement, forcing it to keep momentum.
 		bRemoveBlocking = true;
 	}
 
-	// Store the current transform for the resting check
-	FTransform CurrentTransform = GetActorTransform();
-
 	if (!bRemoveBlocking)
 	{
-		if (!CurrentTransform.GetRotation().Equals(ClientAuthReplicationData.LastActorTransform.GetRotation())
-			|| !CurrentTransform.GetLocation().Equals(ClientAuthReplicationData.LastActorTransform.GetLocation()))
+		if (ClientAuthReplicationData.bGatheredTransformChanged)
 		{
-			ClientAuthReplicationData.LastActorTransform = CurrentTransform;
+			// Store the current transform for the resting check
+			ClientAuthReplicationData.LastActorTransform = ClientAuthReplicationData.GatheredTransform;
 
-			if (const auto PrimitiveComponent = Cast<UPrimitiveComponent>(GetRootComponent()))
+			if (const UPrimitiveComponent* PrimitiveComponent = Cast<UPrimitiveComponent>(GetRootComponent()))
 			{
-				// Need to clamp to a max time since start to handle cases with conflicting collisions
-				// This is a failsafe to prevent the object from getting stuck in the world.
-				if (PrimitiveComponent->IsSimulatingPhysics() && ShouldSkipAttachmentReplication())
+				if (ClientAuthReplicationData.bGatheredMovementValid)
 				{
-					FRepMovementPhysics ClientAuthMovementRep;
-					if (ClientAuthMovementRep.GatherActorsMovement(this))
+					// The parts of the movement that the gather stage couldn't read off the snapshot
+					FRepMovementPhysics& GatheredMovement = ClientAuthReplicationData.GatheredMovement;
+					GatheredMovement.Location = FRepMovement::RebaseOntoZeroOrigin(GatheredMovement.Location, this);
+					GatheredMovement.bRepPhysics = !PrimitiveComponent->IsWelded();
+
+					// The final state before coming to rest always goes out so that the server settles in the right spot
+					if (!ClientAuthReplicationData.bUseErrorGatedSending || !ClientAuthReplicationData.bGatheredRigidBodyAwake || ShouldSendClientAuthMovement(ClientAuthReplicationData.GatheredMovement))
 					{
-						Server_GetClientAuthReplication(ClientAuthMovementRep);
+						SendClientAuthMovement(ClientAuthReplicationData.GatheredMovement);
+						ClientAuthReplicationData.LastSentMovement = ClientAuthReplicationData.GatheredMovement;
+						ClientAuthReplicationData.LastSentTime = World->GetTimeSeconds();
+						ClientAuthReplicationData.bHasSentMovement = true;
+					}
 
-						if (PrimitiveComponent->RigidBodyIsAwake())
+					if (ClientAuthReplicationData.bGatheredRigidBodyAwake)
+					{
+						if (ClientAuthReplicationData.bUseAdaptiveUpdateRate)
 						{
-							return true;
+							UpdateAdaptiveUpdateRate();
 						}
+
+						return true;
 					}
 				}
 			}
@@ -389,33 +829,15 @@ bool AReplicatedPhysicsActor::PollReplicationEvent()
 		}
 	}
 
+	// Keep ignoring server movement until the server's handback frame shows up in it (TryCompleteClientAuthHandback)
+	// The timer is only the fallback, adding under the same name replaces a pending release so this re-arms it
 	bool bTimedBlockingRelease = false;
-	AActor* TopOwner = GetOwner();
-	if (TopOwner != nullptr)
+	// With resimulation server movement was never ignored, so there is nothing to hand back
+	if (!bUseResimulation && ClientAuthReplicationData.HandbackTimeout > 0.f)
 	{
-		AActor* TempOwner = TopOwner->GetOwner();
-
-		while (TempOwner)
-		{
-			TopOwner = TempOwner;
-			TempOwner = TopOwner->GetOwner();
-		}
-
-		if (const auto PlayerController = Cast<APlayerController>(TopOwner))
-		{
-			if (const auto PlayerState = PlayerController->PlayerState)
-			{
-				if (ClientAuthReplicationData.ResetReplicationHandle.IsValid())
-				{
-					World->GetTimerManager().ClearTimer(ClientAuthReplicationData.ResetReplicationHandle);
-				}
-
-				// Clamp the ping to a min/max value
-				float ClampedPing = FMath::Clamp(PlayerState->ExactPing, 0.f, 1000.f);
-				World->GetTimerManager().SetTimer(ClientAuthReplicationData.ResetReplicationHandle, this, &ThisClass::CeaseReplicationBlocking, ClampedPing, false);
-				bTimedBlockingRelease = true;
-			}
-		}
+		ClientAuthReplicationData.bIsAwaitingHandback = true;
+		ClientAuthReplicationData.ResetReplicationHandle = World->GetSubsystem<UPhysicsBucketUpdateSubsystem>()->AddOneShotTimer(ClientAuthReplicationData.HandbackTimeout, this, &ThisClass::CeaseReplicationBlocking, GET_FUNCTION_NAME_CHECKED(ThisClass, CeaseReplicationBlocking));
+		bTimedBlockingRelease = ClientAuthReplicationData.ResetReplicationHandle.IsValid();
 	}
 
 	if (!bTimedBlockingRelease)
@@ -424,11 +846,44 @@ bool AReplicatedPhysicsActor::PollReplicationEvent()
 	}
 
 	// Tell server to kill us
-	Server_EndClientAuthReplication();
+	SendEndClientAuthReplication();
 
 	return false; // Tell the bucket subsystem to remove us from consideration
 }
 
+bool AReplicatedPhysicsActor::GatherClientAuthState()
+{
+	FPhysicsClientAuthReplicationData& ClientAuthData = ClientAuthReplicationData;
+	ClientAuthData.bGatheredMovementValid = false;
+	ClientAuthData.bGatheredRigidBodyAwake = false;
+
+	// Only simulating bodies are valid in the snapshot, anything else ends the session the same way a stopped body does
+	FGatheredPhysicsState GatheredState;
+	if (!ClientAuthGatherSubsystem || !ClientAuthGatherSubsystem->PeekGatheredPhysicsState(PhysicsStateGatherSlot, GatheredState))
+	{
+		ClientAuthData.bGatheredTransformChanged = true;
+		return true;
+	}
+
+	// The root body is the actor's transform, scale aside which the resting check doesn't look at
+	ClientAuthData.GatheredTransform = FTransform(GatheredState.State.Quaternion, GatheredState.State.Position);
+	ClientAuthData.bGatheredTransformChanged = !ClientAuthData.GatheredTransform.GetRotation().Equals(ClientAuthData.LastActorTransform.GetRotation())
+		|| !ClientAuthData.GatheredTransform.GetLocation().Equals(ClientAuthData.LastActorTransform.GetLocation());
+
+	// Need to clamp to a max time since start to handle cases with conflicting collisions
+	// This is a failsafe to prevent the object from getting stuck in the world.
+	if (ClientAuthData.bGatheredTransformChanged && ShouldSkipAttachmentReplication())
+	{
+		// No actor to rebase against here, the poll rebases the location and fills in the weld state
+		ClientAuthData.GatheredMovement.FillFrom(GatheredState.State, nullptr, GatheredState.CacheFrame);
+		ClientAuthData.bGatheredMovementValid = true;
+		ClientAuthData.bGatheredRigidBodyAwake = !(GatheredState.State.Flags & ERigidBodyFlags::Sleeping);
+	}
+
+	// The poll always runs, it also times the session out and ends it once the body stops
+	return true;
+}
+
 void AReplicatedPhysicsActor::CeaseReplicationBlocking()
 {
 	if (ClientAuthReplicationData.bIsCurrentlyClientAuth)
@@ -437,16 +892,49 @@ void AReplicatedPhysicsActor::CeaseReplicationBlocking()
 	}
 
 	ClientAuthReplicationData.LastActorTransform = FTransform::Identity;
+	ClientAuthReplicationData.bIsAwaitingHandback = false;
+
+	// The owning client only gathers its body for the sessions
+	if (!HasAuthority() && PhysicsStateGatherSlot != INDEX_NONE && ClientAuthGatherSubsystem)
+	{
+		ClientAuthGatherSubsystem->UnregisterPhysicsStateGather(PhysicsStateGatherSlot);
+	}
 
 	if (ClientAuthReplicationData.ResetReplicationHandle.IsValid())
 	{
 		if (const auto World = GetWorld())
 		{
-			World->GetTimerManager().ClearTimer(ClientAuthReplicationData.ResetReplicationHandle);
+			World->GetSubsystem<UPhysicsBucketUpdateSubsystem>()->RemoveBucketEntry(ClientAuthReplicationData.ResetReplicationHandle);
 		}
 	}
 }
 
+bool AReplicatedPhysicsActor::TryCompleteClientAuthHandback()
+{
+	if (!ClientAuthReplicationData.bIsAwaitingHandback)
+		return false;
+
+	// A handback for sequences before this session belongs to an earlier throw
+	const FClientAuthHandbackState& Handback = ClientAuthHandback;
+	if (Handback.HandbackFrame == INDEX_NONE || (int16)(Handback.HandbackSequence - ClientAuthReplicationData.SessionFirstSequence) < 0)
+		return false;
+
+	if (Handback.MovementFrame == INDEX_NONE || Handback.MovementFrame < Handback.HandbackFrame)
+		return false;
+
+	CeaseReplicationBlocking();
+	return true;
+}
+
+void AReplicatedPhysicsActor::OnRep_ClientAuthHandback()
+{
+	// The movement itself may already be here, apply it now that it is no longer ignored
+	if (TryCompleteClientAuthHandback() && IsReplicatingMovement())
+	{
+		OnRep_ReplicatedMovement();
+	}
+}
+
 FPhysicsClientAuthReplicationData AReplicatedPhysicsActor::GetClientAuthReplicationData(FPhysicsClientAuthReplicationData& ClientAuthData)
 {
 #if WITH_PUSH_MODEL
@@ -455,23 +943,252 @@ FPhysicsClientAuthReplicationData AReplicatedPhysicsActor::GetClientAuthReplicat
 	return ClientAuthReplicationData;
 }
 
-void AReplicatedPhysicsActor::Server_GetClientAuthReplication_Implementation(const FRepMovementPhysics& NewMovement)
+void AReplicatedPhysicsActor::SendClientAuthMovement(const FRepMovementPhysics& NewMovement)
 {
-	if (!NewMovement.Location.ContainsNaN() && !NewMovement.Rotation.ContainsNaN())
+	UReplicatedPhysicsClientAuthComponent* Batcher = ClientAuthBatcher.Get();
+	if (!Batcher && !ClientAuthReplicationData.bUseDeltaCompression)
 	{
-		FRepMovement& MovementRep = GetReplicatedMovement_Mutable();
-		NewMovement.CopyTo(MovementRep);
-		OnRep_ReplicatedMovement();
+		FRepMovementPhysics EncodedMovement = NewMovement;
+		EncodedMovement.SetEncodingSettings(ClientAuthReplicationData.MaxReplicatedLinearSpeed, ClientAuthReplicationData.MaxReplicatedAngularSpeed, ClientAuthReplicationData.MovementRotationPrecision);
+		Server_GetClientAuthReplication(EncodedMovement, ClientAuthReplicationData.NextSendSequence++);
+		return;
+	}
+
+	FRepClientAuthMovement MovementUpdate;
+	BuildClientAuthMovementUpdate(NewMovement, MovementUpdate);
+
+	if (Batcher)
+	{
+		Batcher->QueueMovement(this, MovementUpdate);
+	}
+	else
+	{
+		Server_GetClientAuthMovementUpdate(MovementUpdate);
+	}
+}
+
+void AReplicatedPhysicsActor::BuildClientAuthMovementUpdate(const FRepMovementPhysics& NewMovement, FRepClientAuthMovement& OutMovementUpdate)
+{
+	FPhysicsClientAuthReplicationData& ClientAuthData = ClientAuthReplicationData;
+
+	// Same encoding settings as the full movement RPC, so both paths send the same grid
+	FRepMovementPhysics EncodedMovement = NewMovement;
+	EncodedMovement.SetEncodingSettings(ClientAuthData.MaxReplicatedLinearSpeed, ClientAuthData.MaxReplicatedAngularSpeed, ClientAuthData.MovementRotationPrecision);
+
+	FQuantizedPhysicsState State;
+	State.FromMovement(EncodedMovement);
+
+	OutMovementUpdate.Sequence = ClientAuthData.NextSendSequence++;
+
+	// Only encode against the ack if it is from this session and recent enough, a stale ack means updates are being lost
+	// and the full state gets the server back in sync in one packet
+	const FQuantizedPhysicsState* Baseline = nullptr;
+	if (ClientAuthData.bUseDeltaCompression)
+	{
+		const bool bAckIsFromSession = (int16)(ClientAuthAckSequence - ClientAuthData.SessionFirstSequence) >= 0;
+		const bool bAckIsRecent = (uint16)(OutMovementUpdate.Sequence - ClientAuthAckSequence) <= ClientAuthData.MaxDeltaBaselineAge;
+		if (bAckIsFromSession && bAckIsRecent)
+		{
+			Baseline = ClientAuthData.SentStates.Find(ClientAuthAckSequence);
+		}
+
+		// Settings changed since the baseline, its grid doesn't line up with ours anymore
+		if (Baseline && !Baseline->HasSameEncoding(State))
+		{
+			Baseline = nullptr;
+		}
 	}
+
+	if (Baseline)
+	{
+		OutMovementUpdate.bIsFullState = false;
+		OutMovementUpdate.BaselineSequence = ClientAuthAckSequence;
+		OutMovementUpdate.State = State.GetDeltaFrom(*Baseline);
+	}
+	else
+	{
+		OutMovementUpdate.bIsFullState = true;
+		OutMovementUpdate.State = State;
+	}
+
+	ClientAuthData.SentStates.Store(OutMovementUpdate.Sequence, State);
+}
+
+void AReplicatedPhysicsActor::SendEndClientAuthReplication()
+{
+	if (UReplicatedPhysicsClientAuthComponent* Batcher = ClientAuthBatcher.Get())
+	{
+		Batcher->QueueEndClientAuth(this);
+	}
+	else
+	{
+		Server_EndClientAuthReplication();
+	}
+}
+
+void AReplicatedPhysicsActor::Server_GetClientAuthReplication_Implementation(const FRepMovementPhysics& NewMovement, uint16 Sequence)
+{
+	ApplyClientAuthMovement(NewMovement, Sequence);
+}
+
+void AReplicatedPhysicsActor::Server_GetClientAuthMovementUpdate_Implementation(const FRepClientAuthMovement& MovementUpdate)
+{
+	ApplyClientAuthMovementUpdate(MovementUpdate);
+}
+
+bool AReplicatedPhysicsActor::Server_GetClientAuthMovementUpdate_Validate(const FRepClientAuthMovement& MovementUpdate)
+{
+	return true;
+}
+
+void AReplicatedPhysicsActor::ApplyClientAuthMovementUpdate(const FRepClientAuthMovement& MovementUpdate)
+{
+	// A late update is never a baseline either, the client only encodes against our newest ack
+	if (!AcceptClientAuthSequence(MovementUpdate.Sequence))
+		return;
+
+	FQuantizedPhysicsState State = MovementUpdate.State;
+	if (!MovementUpdate.bIsFullState)
+	{
+		// Without the baseline there is nothing to rebuild from, the client sends a full state once our ack goes stale
+		const FQuantizedPhysicsState* Baseline = ReceivedClientAuthStates.Find(MovementUpdate.BaselineSequence);
+		if (!Baseline)
+			return;
+
+		State = Baseline->AddDelta(MovementUpdate.State);
+	}
+
+	ReceivedClientAuthStates.Store(MovementUpdate.Sequence, State);
+
+	if ((int16)(MovementUpdate.Sequence - ClientAuthAckSequence) > 0)
+	{
+		ClientAuthAckSequence = MovementUpdate.Sequence;
+#if WITH_PUSH_MODEL
+		MARK_PROPERTY_DIRTY_FROM_NAME(ThisClass, ClientAuthAckSequence, this);
+#endif
+	}
+
+	FRepMovementPhysics NewMovement;
+	State.ToMovement(NewMovement);
+	QueueClientAuthMovement(NewMovement);
+}
+
+void AReplicatedPhysicsActor::ApplyClientAuthMovement(const FRepMovementPhysics& NewMovement, uint16 Sequence)
+{
+	if (AcceptClientAuthSequence(Sequence))
+	{
+		QueueClientAuthMovement(NewMovement);
+	}
+}
+
+bool AReplicatedPhysicsActor::AcceptClientAuthSequence(uint16 Sequence)
+{
+	// Also catches the owner reconnecting or being respawned on another connection without SetOwner being called on us
+	if (ClientAuthSequenceConnection.Get() != GetNetConnection())
+	{
+		ResetClientAuthReceiveState();
+	}
+
+	// Compared in wrapped space, the session end and throttled sends keep the gaps far below half the range
+	if (bHasReceivedClientAuthSequence && (int16)(Sequence - NewestClientAuthSequence) <= 0)
+		return false;
+
+	NewestClientAuthSequence = Sequence;
+	bHasReceivedClientAuthSequence = true;
+	return true;
+}
+
+void AReplicatedPhysicsActor::ResetClientAuthReceiveState()
+{
+	ClientAuthSequenceConnection = GetNetConnection();
+	NewestClientAuthSequence = 0;
+	bHasReceivedClientAuthSequence = false;
+	ReceivedClientAuthStates.Reset();
+
+	// The ack and the handback are in the previous client's sequence space, the new one would mistake them for its own
+	ClientAuthAckSequence = 0;
+	ClientAuthHandback = FClientAuthHandbackState();
+	ClientAuthHandbackWindowEndTime = -1.f;
+#if WITH_PUSH_MODEL
+	MARK_PROPERTY_DIRTY_FROM_NAME(ThisClass, ClientAuthAckSequence, this);
+	MARK_PROPERTY_DIRTY_FROM_NAME(ThisClass, ClientAuthHandback, this);
+#endif
+}
+
+void AReplicatedPhysicsActor::QueueClientAuthMovement(const FRepMovementPhysics& NewMovement)
+{
+	if (NewMovement.Location.ContainsNaN() || NewMovement.Rotation.ContainsNaN())
+		return;
+
+	// The session started while we were asleep on the server
+	WakeFromSleepDormancy();
+
+	PendingClientAuthMovement = NewMovement;
+
+	if (!bHasPendingClientAuthMovement)
+	{
+		bHasPendingClientAuthMovement = true;
+
+		UWorld* World = GetWorld();
+		UPhysicsBucketUpdateSubsystem* BucketSubsystem = World ? World->GetSubsystem<UPhysicsBucketUpdateSubsystem>() : nullptr;
+		if (BucketSubsystem)
+		{
+			BucketSubsystem->QueuePrePhysicsApply(this, &ThisClass::ApplyPendingClientAuthMovement);
+		}
+		else
+		{
+			ApplyPendingClientAuthMovement();
+		}
+	}
+}
+
+void AReplicatedPhysicsActor::ApplyPendingClientAuthMovement()
+{
+	if (!bHasPendingClientAuthMovement)
+		return;
+
+	bHasPendingClientAuthMovement = false;
+
+	FRepMovement& MovementRep = GetReplicatedMovement_Mutable();
+	PendingClientAuthMovement.CopyTo(MovementRep);
+	OnRep_ReplicatedMovement();
 }
 
-bool AReplicatedPhysicsActor::Server_GetClientAuthReplication_Validate(const FRepMovementPhysics& NewMovement)
+bool AReplicatedPhysicsActor::Server_GetClientAuthReplication_Validate(const FRepMovementPhysics& NewMovement, uint16 Sequence)
 {
 	return true;
 }
 
 void AReplicatedPhysicsActor::Server_EndClientAuthReplication_Implementation()
 {
+	EndClientAuthReplication();
+}
+
+void AReplicatedPhysicsActor::EndClientAuthReplication()
+{
+	// The handback has to be in the sequence space of whoever ended the session
+	if (ClientAuthSequenceConnection.Get() != GetNetConnection())
+	{
+		ResetClientAuthReceiveState();
+	}
+
+	ReceivedClientAuthStates.Reset();
+
+	// The target is removed below, a queued state would only put it back
+	bHasPendingClientAuthMovement = false;
+
+	if (const auto World = GetWorld())
+	{
+		// Everything we simulate from this frame on is ours again, the owner waits for movement from at or after it
+		ClientAuthHandback.HandbackFrame = ReplicatedPhysicsHandback::GetServerPhysicsFrame(World);
+		ClientAuthHandback.HandbackSequence = NewestClientAuthSequence;
+		ClientAuthHandbackWindowEndTime = World->GetTimeSeconds() + FMath::Max(ClientAuthReplicationData.HandbackTimeout, 0.f);
+#if WITH_PUSH_MODEL
+		MARK_PROPERTY_DIRTY_FROM_NAME(ThisClass, ClientAuthHandback, this);
+#endif
+		ForceNetUpdate();
+	}
+
 	if (const auto World = GetWorld())
 	{
 		if (const auto PrimitiveComponent = Cast<UPrimitiveComponent>(GetRootComponent()))
@@ -0,0 +1,197 @@
+﻿// Copyright Hitbox Games, LLC. All Rights Reserved.
+
+#include "ReplicatedPhysicsClientAuthComponent.h"
+
+#include "GameFramework/PlayerController.h"
+#include "PhysicsBucketUpdateSubsystem.h"
+#include "ReplicatedPhysicsActor.h"
+
+#include UE_INLINE_GENERATED_CPP_BY_NAME(ReplicatedPhysicsClientAuthComponent)
+
+UReplicatedPhysicsClientAuthComponent::UReplicatedPhysicsClientAuthComponent()
+{
+	PrimaryComponentTick.bCanEverTick = false;
+	SetIsReplicatedByDefault(true);
+}
+
+void UReplicatedPhysicsClientAuthComponent::BeginPlay()
+{
+	Super::BeginPlay();
+
+	// Only the owning client sends batches, flush right after the buckets fire so that everything polled this frame goes together
+	const APlayerController* PlayerController = Cast<APlayerController>(GetOwner());
+	if (PlayerController && PlayerController->IsLocalController())
+	{
+		if (UPhysicsBucketUpdateSubsystem* BucketSubsystem = GetWorld()->GetSubsystem<UPhysicsBucketUpdateSubsystem>())
+		{
+			BucketsDispatchedHandle = BucketSubsystem->OnBucketsDispatched.AddUObject(this, &ThisClass::FlushBatch);
+		}
+	}
+}
+
+void UReplicatedPhysicsClientAuthComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (BucketsDispatchedHandle.IsValid())
+	{
+		if (UPhysicsBucketUpdateSubsystem* BucketSubsystem = GetWorld()->GetSubsystem<UPhysicsBucketUpdateSubsystem>())
+		{
+			BucketSubsystem->OnBucketsDispatched.Remove(BucketsDispatchedHandle);
+		}
+
+		BucketsDispatchedHandle.Reset();
+	}
+
+	PendingMovements.Reset();
+	PendingEnds.Reset();
+
+	Super::EndPlay(EndPlayReason);
+}
+
+UReplicatedPhysicsClientAuthComponent* UReplicatedPhysicsClientAuthComponent::FindForActor(const AActor* InActor)
+{
+	UReplicatedPhysicsClientAuthComponent* BatchComponent = FindOwningComponent(InActor);
+	return BatchComponent && BatchComponent->BucketsDispatchedHandle.IsValid() ? BatchComponent : nullptr;
+}
+
+UReplicatedPhysicsClientAuthComponent* UReplicatedPhysicsClientAuthComponent::FindOwningComponent(const AActor* InActor)
+{
+	if (!InActor)
+		return nullptr;
+
+	AActor* TopOwner = InActor->GetOwner();
+	if (TopOwner == nullptr)
+		return nullptr;
+
+	AActor* TempOwner = TopOwner->GetOwner();
+	while (TempOwner)
+	{
+		TopOwner = TempOwner;
+		TempOwner = TopOwner->GetOwner();
+	}
+
+	if (const auto PlayerController = Cast<APlayerController>(TopOwner))
+	{
+		UReplicatedPhysicsClientAuthComponent* BatchComponent = PlayerController->FindComponentByClass<UReplicatedPhysicsClientAuthComponent>();
+		if (BatchComponent && BatchComponent->bBatchClientAuthRPCs)
+		{
+			return BatchComponent;
+		}
+	}
+
+	return nullptr;
+}
+
+void UReplicatedPhysicsClientAuthComponent::QueueMovement(AReplicatedPhysicsActor* InActor, const FRepClientAuthMovement& NewMovement)
+{
+	if (!InActor)
+		return;
+
+	// Only the latest state of an actor matters, replace rather than append if it polled twice before a flush
+	for (FRepClientAuthBatchEntry& Entry : PendingMovements)
+	{
+		if (Entry.Actor == InActor)
+		{
+			Entry.Movement = NewMovement;
+			return;
+		}
+	}
+
+	FRepClientAuthBatchEntry& Entry = PendingMovements.AddDefaulted_GetRef();
+	Entry.Actor = InActor;
+	Entry.Movement = NewMovement;
+}
+
+void UReplicatedPhysicsClientAuthComponent::QueueEndClientAuth(AReplicatedPhysicsActor* InActor)
+{
+	if (InActor)
+	{
+		PendingEnds.AddUnique(InActor);
+	}
+}
+
+void UReplicatedPhysicsClientAuthComponent::FlushBatch()
+{
+	// Actors destroyed since they queued have nothing left to send
+	PendingMovements.RemoveAllSwap([](const FRepClientAuthBatchEntry& Entry)
+	{
+		return !IsValid(Entry.Actor);
+	}, EAllowShrinking::No);
+
+	if (PendingMovements.Num() > 0)
+	{
+		// The movements go first so that the final state of an ending session is applied before its end
+		const int32 BatchSize = FMath::Max(MaxMovementsPerRPC, 1);
+		if (PendingMovements.Num() <= BatchSize)
+		{
+			Server_ReceiveClientAuthBatch(PendingMovements);
+		}
+		else
+		{
+			for (int32 Start = 0; Start < PendingMovements.Num(); Start += BatchSize)
+			{
+				ScratchMovements.Reset();
+				ScratchMovements.Append(PendingMovements.GetData() + Start, FMath::Min(BatchSize, PendingMovements.Num() - Start));
+				Server_ReceiveClientAuthBatch(ScratchMovements);
+			}
+		}
+
+		PendingMovements.Reset();
+	}
+
+	if (PendingEnds.Num() > 0)
+	{
+		ScratchEnds.Reset();
+		for (AReplicatedPhysicsActor* EndedActor : PendingEnds)
+		{
+			if (IsValid(EndedActor))
+			{
+				ScratchEnds.Add(EndedActor);
+			}
+		}
+
+		if (ScratchEnds.Num() > 0)
+		{
+			Server_EndClientAuthBatch(ScratchEnds);
+		}
+
+		PendingEnds.Reset();
+	}
+}
+
+bool UReplicatedPhysicsClientAuthComponent::IsOwnedActor(const AReplicatedPhysicsActor* InActor) const
+{
+	// Mirrors the ownership check that a server RPC on the actor itself would have had
+	return InActor && GetOwner() && InActor->GetNetConnection() != nullptr && InActor->GetNetConnection() == GetOwner()->GetNetConnection();
+}
+
+void UReplicatedPhysicsClientAuthComponent::Server_ReceiveClientAuthBatch_Implementation(const TArray<FRepClientAuthBatchEntry>& Movements)
+{
+	for (const FRepClientAuthBatchEntry& Entry : Movements)
+	{
+		if (IsOwnedActor(Entry.Actor))
+		{
+			Entry.Actor->ApplyClientAuthMovementUpdate(Entry.Movement);
+		}
+	}
+}
+
+bool UReplicatedPhysicsClientAuthComponent::Server_ReceiveClientAuthBatch_Validate(const TArray<FRepClientAuthBatchEntry>& Movements)
+{
+	return true;
+}
+
+void UReplicatedPhysicsClientAuthComponent::Server_EndClientAuthBatch_Implementation(const TArray<AReplicatedPhysicsActor*>& Actors)
+{
+	for (AReplicatedPhysicsActor* EndedActor : Actors)
+	{
+		if (IsOwnedActor(EndedActor))
+		{
+			EndedActor->EndClientAuthReplication();
+		}
+	}
+}
+
+bool UReplicatedPhysicsClientAuthComponent::Server_EndClientAuthBatch_Validate(const TArray<AReplicatedPhysicsActor*>& Actors)
+{
+	return true;
+}
@@ -2,8 +2,14 @@
 
 #include "IReplicatedPhysicsModule.h"
 
+#include "ReplicatedPhysicsStats.h"
+
 #define LOCTEXT_NAMESPACE "ReplicatedPhysics"
 
+DEFINE_LOG_CATEGORY(LogReplicatedPhysics);
+
+CSV_DEFINE_CATEGORY_MODULE(REPLICATEDPHYSICS_API, ReplicatedPhysics, true);
+
 class FReplicatedPhysicsModule : public IReplicatedPhysicsModule
 {
 };
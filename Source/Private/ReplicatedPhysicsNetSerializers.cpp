@@ -0,0 +1,524 @@
+﻿// Copyright Hitbox Games, LLC. All Rights Reserved.
+
+#include "ReplicatedPhysicsNetSerializers.h"
+
+#include "Iris/ReplicationState/PropertyNetSerializerInfoRegistry.h"
+#include "Iris/Serialization/NetBitStreamReader.h"
+#include "Iris/Serialization/NetBitStreamWriter.h"
+#include "Iris/Serialization/NetSerializerDelegates.h"
+#include "ReplicatedPhysicsQuantization.h"
+
+#include UE_INLINE_GENERATED_CPP_BY_NAME(ReplicatedPhysicsNetSerializers)
+
+namespace UE::Net
+{
+
+struct FRepMovementPhysicsNetSerializer
+{
+	static constexpr uint32 Version = 1;
+
+	// Delta is written against the previous quantized state, group by group
+	static constexpr bool bUseDefaultDelta = false;
+
+	enum EFlags : uint8
+	{
+		SimulatedPhysicSleep = 1 << 0,
+		RepPhysics = 1 << 1,
+	};
+
+	enum EDeltaGroups : uint8
+	{
+		HeaderGroup = 1 << 0,
+		LocationGroup = 1 << 1,
+		RotationGroup = 1 << 2,
+		LinearVelocityGroup = 1 << 3,
+		AngularVelocityGroup = 1 << 4,
+
+		NumDeltaGroupBits = 5
+	};
+
+	struct FQuantizedData
+	{
+		// Locations off the int32 grid are kept as is, Location is zero for those
+		double FullPrecisionLocation[3];
+		int32 Location[3];
+		uint32 Rotation[3];
+		uint16 LinearVelocity[3];
+		uint16 AngularVelocity[3];
+		uint8 RotationLargestIndex;
+		uint8 RotationPrecision;
+		uint8 LocationQuantizationLevel;
+		uint8 LinearVelocityRangeExponent;
+		uint8 AngularVelocityRangeExponent;
+		uint8 Flags;
+		uint8 bFullPrecisionLocation;
+	};
+
+	typedef FRepMovementPhysics SourceType;
+	typedef FQuantizedData QuantizedType;
+	typedef FRepMovementPhysicsNetSerializerConfig ConfigType;
+
+	static const ConfigType DefaultConfig;
+
+	static void Serialize(FNetSerializationContext& Context, const FNetSerializeArgs& Args);
+	static void Deserialize(FNetSerializationContext& Context, const FNetDeserializeArgs& Args);
+
+	static void SerializeDelta(FNetSerializationContext& Context, const FNetSerializeDeltaArgs& Args);
+	static void DeserializeDelta(FNetSerializationContext& Context, const FNetDeserializeDeltaArgs& Args);
+
+	static void Quantize(FNetSerializationContext& Context, const FNetQuantizeArgs& Args);
+	static void Dequantize(FNetSerializationContext& Context, const FNetDequantizeArgs& Args);
+
+	static bool IsEqual(FNetSerializationContext& Context, const FNetIsEqualArgs& Args);
+	static bool Validate(FNetSerializationContext& Context, const FNetValidateArgs& Args);
+
+private:
+	static void QuantizeMovement(const SourceType& Source, QuantizedType& Target);
+	static bool IsQuantizedEqual(const QuantizedType& Value0, const QuantizedType& Value1);
+
+	static bool IsGroupEqual(const QuantizedType& Value0, const QuantizedType& Value1, EDeltaGroups Group);
+	static void WriteGroup(FNetBitStreamWriter& Writer, const QuantizedType& Value, const QuantizedType* Prev, EDeltaGroups Group);
+	static void ReadGroup(FNetBitStreamReader& Reader, QuantizedType& Value, const QuantizedType* Prev, EDeltaGroups Group);
+};
+
+UE_NET_IMPLEMENT_SERIALIZER(FRepMovementPhysicsNetSerializer);
+
+const FRepMovementPhysicsNetSerializer::ConfigType FRepMovementPhysicsNetSerializer::DefaultConfig;
+
+namespace RepMovementPhysicsNetSerializer
+{
+	// Zig zag followed by the significant bits, small location deltas stay small
+	static void WritePackedInt(FNetBitStreamWriter& Writer, int32 Value)
+	{
+		using namespace ReplicatedPhysicsQuantization;
+
+		const uint32 Encoded = ZigZagEncode(Value);
+		const uint32 BitCount = GetPackedIntBits(Encoded);
+		Writer.WriteBits(BitCount, PackedBitCountBits);
+		if (BitCount > 0)
+		{
+			Writer.WriteBits(Encoded, BitCount);
+		}
+	}
+
+	static int32 ReadPackedInt(FNetBitStreamReader& Reader)
+	{
+		using namespace ReplicatedPhysicsQuantization;
+
+		const uint32 BitCount = FMath::Min(Reader.ReadBits(PackedBitCountBits), 32u);
+		const uint32 Encoded = BitCount > 0 ? Reader.ReadBits(BitCount) : 0;
+		return ZigZagDecode(Encoded);
+	}
+
+	// Doubles go out as their raw bits, NaN and infinities are read back as zero
+	static void WriteDouble(FNetBitStreamWriter& Writer, double Value)
+	{
+		uint64 Bits = 0;
+		FMemory::Memcpy(&Bits, &Value, sizeof(Bits));
+		Writer.WriteBits((uint32)Bits, 32);
+		Writer.WriteBits((uint32)(Bits >> 32), 32);
+	}
+
+	static double ReadDouble(FNetBitStreamReader& Reader)
+	{
+		const uint64 Low = Reader.ReadBits(32);
+		const uint64 High = Reader.ReadBits(32);
+		const uint64 Bits = Low | (High << 32);
+
+		double Value = 0.0;
+		FMemory::Memcpy(&Value, &Bits, sizeof(Value));
+		return FMath::IsFinite(Value) ? Value : 0.0;
+	}
+
+	static bool IsZeroVelocity(const uint16 Velocity[3])
+	{
+		using namespace ReplicatedPhysicsQuantization;
+		return Velocity[0] == VelocityComponentMax && Velocity[1] == VelocityComponentMax && Velocity[2] == VelocityComponentMax;
+	}
+
+	static void WriteVelocity(FNetBitStreamWriter& Writer, const uint16 Velocity[3])
+	{
+		using namespace ReplicatedPhysicsQuantization;
+
+		const bool bIsZero = IsZeroVelocity(Velocity);
+		Writer.WriteBool(bIsZero);
+		if (!bIsZero)
+		{
+			for (int32 i = 0; i < 3; ++i)
+			{
+				Writer.WriteBits(Velocity[i], VelocityComponentBits);
+			}
+		}
+	}
+
+	static void ReadVelocity(FNetBitStreamReader& Reader, uint16 Velocity[3])
+	{
+		using namespace ReplicatedPhysicsQuantization;
+
+		const bool bIsZero = Reader.ReadBool();
+		for (int32 i = 0; i < 3; ++i)
+		{
+			Velocity[i] = bIsZero ? (uint16)VelocityComponentMax : (uint16)Reader.ReadBits(VelocityComponentBits);
+		}
+	}
+}
+
+void FRepMovementPhysicsNetSerializer::QuantizeMovement(const SourceType& Source, QuantizedType& Target)
+{
+	using namespace ReplicatedPhysicsQuantization;
+
+	FMemory::Memzero(Target);
+
+	Target.Flags = (Source.bSimulatedPhysicSleep ? SimulatedPhysicSleep : 0) | (Source.bRepPhysics ? RepPhysics : 0);
+	Target.RotationPrecision = (uint8)Source.RotationPrecision;
+	Target.LocationQuantizationLevel = (uint8)Source.LocationQuantizationLevel;
+	Target.LinearVelocityRangeExponent = Source.LinearVelocityRangeExponent;
+	Target.AngularVelocityRangeExponent = Source.AngularVelocityRangeExponent;
+
+	const float LocationScale = GetLocationScale(Source.LocationQuantizationLevel);
+	Target.bFullPrecisionLocation = IsLocationOnGrid(Source.Location, LocationScale) ? 0 : 1;
+	for (int32 i = 0; i < 3; ++i)
+	{
+		if (Target.bFullPrecisionLocation)
+		{
+			Target.FullPrecisionLocation[i] = Source.Location[i];
+		}
+		else
+		{
+			Target.Location[i] = QuantizeLocationComponent(Source.Location[i], LocationScale);
+		}
+
+		Target.LinearVelocity[i] = QuantizeBoundedComponent((float)Source.LinearVelocity[i], Source.LinearVelocityRangeExponent);
+
+		// Without physics the angular velocity is never sent, keep it out of the equality too
+		Target.AngularVelocity[i] = QuantizeBoundedComponent(Source.bRepPhysics ? (float)Source.AngularVelocity[i] : 0.f, Source.AngularVelocityRangeExponent);
+	}
+
+	QuantizeSmallestThree(Source.Rotation, GetRotationComponentBits(Source.RotationPrecision), Target.RotationLargestIndex, Target.Rotation);
+}
+
+bool FRepMovementPhysicsNetSerializer::IsGroupEqual(const QuantizedType& Value0, const QuantizedType& Value1, EDeltaGroups Group)
+{
+	switch (Group)
+	{
+	case HeaderGroup:
+		return Value0.Flags == Value1.Flags
+			&& Value0.RotationPrecision == Value1.RotationPrecision
+			&& Value0.LocationQuantizationLevel == Value1.LocationQuantizationLevel
+			&& Value0.LinearVelocityRangeExponent == Value1.LinearVelocityRangeExponent
+			&& Value0.AngularVelocityRangeExponent == Value1.AngularVelocityRangeExponent;
+	case LocationGroup:
+		return Value0.bFullPrecisionLocation == Value1.bFullPrecisionLocation
+			&& FMemory::Memcmp(Value0.Location, Value1.Location, sizeof(Value0.Location)) == 0
+			&& FMemory::Memcmp(Value0.FullPrecisionLocation, Value1.FullPrecisionLocation, sizeof(Value0.FullPrecisionLocation)) == 0;
+	case RotationGroup:
+		return Value0.RotationLargestIndex == Value1.RotationLargestIndex && FMemory::Memcmp(Value0.Rotation, Value1.Rotation, sizeof(Value0.Rotation)) == 0;
+	case LinearVelocityGroup:
+		return FMemory::Memcmp(Value0.LinearVelocity, Value1.LinearVelocity, sizeof(Value0.LinearVelocity)) == 0;
+	case AngularVelocityGroup:
+		return FMemory::Memcmp(Value0.AngularVelocity, Value1.AngularVelocity, sizeof(Value0.AngularVelocity)) == 0;
+	default:
+		return true;
+	}
+}
+
+bool FRepMovementPhysicsNetSerializer::IsQuantizedEqual(const QuantizedType& Value0, const QuantizedType& Value1)
+{
+	return IsGroupEqual(Value0, Value1, HeaderGroup)
+		&& IsGroupEqual(Value0, Value1, LocationGroup)
+		&& IsGroupEqual(Value0, Value1, RotationGroup)
+		&& IsGroupEqual(Value0, Value1, LinearVelocityGroup)
+		&& IsGroupEqual(Value0, Value1, AngularVelocityGroup);
+}
+
+void FRepMovementPhysicsNetSerializer::WriteGroup(FNetBitStreamWriter& Writer, const QuantizedType& Value, const QuantizedType* Prev, EDeltaGroups Group)
+{
+	using namespace ReplicatedPhysicsQuantization;
+	using namespace RepMovementPhysicsNetSerializer;
+
+	switch (Group)
+	{
+	case HeaderGroup:
+		Writer.WriteBits(Value.Flags, 2);
+		Writer.WriteBits(Value.RotationPrecision, 2);
+		Writer.WriteBits(Value.LocationQuantizationLevel, 2);
+		Writer.WriteBits(Value.LinearVelocityRangeExponent, RangeExponentBits);
+		Writer.WriteBits(Value.AngularVelocityRangeExponent, RangeExponentBits);
+		break;
+	case LocationGroup:
+	{
+		Writer.WriteBool(Value.bFullPrecisionLocation != 0);
+		if (Value.bFullPrecisionLocation)
+		{
+			for (int32 i = 0; i < 3; ++i)
+			{
+				WriteDouble(Writer, Value.FullPrecisionLocation[i]);
+			}
+
+			break;
+		}
+
+		// A full precision previous value has nothing on the grid to be a delta against
+		const QuantizedType* GridPrev = (Prev && !Prev->bFullPrecisionLocation) ? Prev : nullptr;
+		for (int32 i = 0; i < 3; ++i)
+		{
+			WritePackedInt(Writer, GridPrev ? (int32)((uint32)Value.Location[i] - (uint32)GridPrev->Location[i]) : Value.Location[i]);
+		}
+		break;
+	}
+	case RotationGroup:
+	{
+		const int32 ComponentBits = GetRotationComponentBits((ERepPhysicsRotationPrecision)Value.RotationPrecision);
+		Writer.WriteBits(Value.RotationLargestIndex, 2);
+		for (int32 i = 0; i < 3; ++i)
+		{
+			Writer.WriteBits(Value.Rotation[i], ComponentBits);
+		}
+		break;
+	}
+	case LinearVelocityGroup:
+		WriteVelocity(Writer, Value.LinearVelocity);
+		break;
+	case AngularVelocityGroup:
+		WriteVelocity(Writer, Value.AngularVelocity);
+		break;
+	default:
+		break;
+	}
+}
+
+void FRepMovementPhysicsNetSerializer::ReadGroup(FNetBitStreamReader& Reader, QuantizedType& Value, const QuantizedType* Prev, EDeltaGroups Group)
+{
+	using namespace ReplicatedPhysicsQuantization;
+	using namespace RepMovementPhysicsNetSerializer;
+
+	switch (Group)
+	{
+	case HeaderGroup:
+		Value.Flags = (uint8)Reader.ReadBits(2);
+		Value.RotationPrecision = (uint8)FMath::Min(Reader.ReadBits(2), (uint32)ERepPhysicsRotationPrecision::High);
+		Value.LocationQuantizationLevel = (uint8)FMath::Min(Reader.ReadBits(2), (uint32)EVectorQuantization::RoundTwoDecimals);
+		Value.LinearVelocityRangeExponent = (uint8)Reader.ReadBits(RangeExponentBits);
+		Value.AngularVelocityRangeExponent = (uint8)Reader.ReadBits(RangeExponentBits);
+		break;
+	case LocationGroup:
+	{
+		Value.bFullPrecisionLocation = Reader.ReadBool() ? 1 : 0;
+		if (Value.bFullPrecisionLocation)
+		{
+			for (int32 i = 0; i < 3; ++i)
+			{
+				Value.FullPrecisionLocation[i] = ReadDouble(Reader);
+				Value.Location[i] = 0;
+			}
+
+			break;
+		}
+
+		const QuantizedType* GridPrev = (Prev && !Prev->bFullPrecisionLocation) ? Prev : nullptr;
+		for (int32 i = 0; i < 3; ++i)
+		{
+			const int32 Delta = ReadPackedInt(Reader);
+			Value.Location[i] = GridPrev ? (int32)((uint32)GridPrev->Location[i] + (uint32)Delta) : Delta;
+			Value.FullPrecisionLocation[i] = 0.0;
+		}
+		break;
+	}
+	case RotationGroup:
+	{
+		const int32 ComponentBits = GetRotationComponentBits((ERepPhysicsRotationPrecision)Value.RotationPrecision);
+		Value.RotationLargestIndex = (uint8)Reader.ReadBits(2);
+		for (int32 i = 0; i < 3; ++i)
+		{
+			Value.Rotation[i] = Reader.ReadBits(ComponentBits);
+		}
+		break;
+	}
+	case LinearVelocityGroup:
+		ReadVelocity(Reader, Value.LinearVelocity);
+		break;
+	case AngularVelocityGroup:
+		ReadVelocity(Reader, Value.AngularVelocity);
+		break;
+	default:
+		break;
+	}
+}
+
+void FRepMovementPhysicsNetSerializer::Serialize(FNetSerializationContext& Context, const FNetSerializeArgs& Args)
+{
+	const QuantizedType& Value = *reinterpret_cast<const QuantizedType*>(Args.Source);
+	FNetBitStreamWriter& Writer = *Context.GetBitStreamWriter();
+
+	WriteGroup(Writer, Value, nullptr, HeaderGroup);
+	WriteGroup(Writer, Value, nullptr, LocationGroup);
+	WriteGroup(Writer, Value, nullptr, RotationGroup);
+	WriteGroup(Writer, Value, nullptr, LinearVelocityGroup);
+
+	// Without physics the angular velocity is never used on the other end
+	if (Value.Flags & RepPhysics)
+	{
+		WriteGroup(Writer, Value, nullptr, AngularVelocityGroup);
+	}
+}
+
+void FRepMovementPhysicsNetSerializer::Deserialize(FNetSerializationContext& Context, const FNetDeserializeArgs& Args)
+{
+	QuantizedType& Value = *reinterpret_cast<QuantizedType*>(Args.Target);
+	FNetBitStreamReader& Reader = *Context.GetBitStreamReader();
+
+	QuantizedType TempValue;
+	FMemory::Memzero(TempValue);
+
+	ReadGroup(Reader, TempValue, nullptr, HeaderGroup);
+	ReadGroup(Reader, TempValue, nullptr, LocationGroup);
+	ReadGroup(Reader, TempValue, nullptr, RotationGroup);
+	ReadGroup(Reader, TempValue, nullptr, LinearVelocityGroup);
+
+	if (TempValue.Flags & RepPhysics)
+	{
+		ReadGroup(Reader, TempValue, nullptr, AngularVelocityGroup);
+	}
+	else
+	{
+		for (uint16& Component : TempValue.AngularVelocity)
+		{
+			Component = (uint16)ReplicatedPhysicsQuantization::VelocityComponentMax;
+		}
+	}
+
+	Value = TempValue;
+}
+
+void FRepMovementPhysicsNetSerializer::SerializeDelta(FNetSerializationContext& Context, const FNetSerializeDeltaArgs& Args)
+{
+	const QuantizedType& Value = *reinterpret_cast<const QuantizedType*>(Args.Source);
+	const QuantizedType& PrevValue = *reinterpret_cast<const QuantizedType*>(Args.Prev);
+	FNetBitStreamWriter& Writer = *Context.GetBitStreamWriter();
+
+	// Only the groups that changed follow the mask, a moving body usually leaves the header and often a velocity alone
+	static constexpr EDeltaGroups Groups[] = { HeaderGroup, LocationGroup, RotationGroup, LinearVelocityGroup, AngularVelocityGroup };
+
+	uint32 ChangedGroups = 0;
+	for (EDeltaGroups Group : Groups)
+	{
+		ChangedGroups |= IsGroupEqual(Value, PrevValue, Group) ? 0 : Group;
+	}
+
+	Writer.WriteBits(ChangedGroups, NumDeltaGroupBits);
+	for (EDeltaGroups Group : Groups)
+	{
+		if (ChangedGroups & Group)
+		{
+			WriteGroup(Writer, Value, &PrevValue, Group);
+		}
+	}
+}
+
+void FRepMovementPhysicsNetSerializer::DeserializeDelta(FNetSerializationContext& Context, const FNetDeserializeDeltaArgs& Args)
+{
+	QuantizedType& Value = *reinterpret_cast<QuantizedType*>(Args.Target);
+	const QuantizedType& PrevValue = *reinterpret_cast<const QuantizedType*>(Args.Prev);
+	FNetBitStreamReader& Reader = *Context.GetBitStreamReader();
+
+	static constexpr EDeltaGroups Groups[] = { HeaderGroup, LocationGroup, RotationGroup, LinearVelocityGroup, AngularVelocityGroup };
+
+	QuantizedType TempValue = PrevValue;
+	const uint32 ChangedGroups = Reader.ReadBits(NumDeltaGroupBits);
+	for (EDeltaGroups Group : Groups)
+	{
+		if (ChangedGroups & Group)
+		{
+			ReadGroup(Reader, TempValue, &PrevValue, Group);
+		}
+	}
+
+	Value = TempValue;
+}
+
+void FRepMovementPhysicsNetSerializer::Quantize(FNetSerializationContext& Context, const FNetQuantizeArgs& Args)
+{
+	const SourceType& Source = *reinterpret_cast<const SourceType*>(Args.Source);
+	QuantizedType& Target = *reinterpret_cast<QuantizedType*>(Args.Target);
+
+	QuantizeMovement(Source, Target);
+}
+
+void FRepMovementPhysicsNetSerializer::Dequantize(FNetSerializationContext& Context, const FNetDequantizeArgs& Args)
+{
+	using namespace ReplicatedPhysicsQuantization;
+
+	const QuantizedType& Source = *reinterpret_cast<const QuantizedType*>(Args.Source);
+	SourceType& Target = *reinterpret_cast<SourceType*>(Args.Target);
+
+	Target.bSimulatedPhysicSleep = (Source.Flags & SimulatedPhysicSleep) != 0;
+	Target.bRepPhysics = (Source.Flags & RepPhysics) != 0;
+	Target.RotationPrecision = (ERepPhysicsRotationPrecision)Source.RotationPrecision;
+	Target.LocationQuantizationLevel = (EVectorQuantization)Source.LocationQuantizationLevel;
+	Target.LinearVelocityRangeExponent = Source.LinearVelocityRangeExponent;
+	Target.AngularVelocityRangeExponent = Source.AngularVelocityRangeExponent;
+
+	const float LocationScale = GetLocationScale(Target.LocationQuantizationLevel);
+	for (int32 i = 0; i < 3; ++i)
+	{
+		Target.Location[i] = Source.bFullPrecisionLocation ? Source.FullPrecisionLocation[i] : Source.Location[i] / LocationScale;
+		Target.LinearVelocity[i] = DequantizeBoundedComponent(Source.LinearVelocity[i], Source.LinearVelocityRangeExponent);
+		Target.AngularVelocity[i] = DequantizeBoundedComponent(Source.AngularVelocity[i], Source.AngularVelocityRangeExponent);
+	}
+
+	Target.Rotation = DequantizeSmallestThree(Source.RotationLargestIndex, Source.Rotation, GetRotationComponentBits(Target.RotationPrecision));
+}
+
+bool FRepMovementPhysicsNetSerializer::IsEqual(FNetSerializationContext& Context, const FNetIsEqualArgs& Args)
+{
+	if (Args.bStateIsQuantized)
+	{
+		return IsQuantizedEqual(*reinterpret_cast<const QuantizedType*>(Args.Source0), *reinterpret_cast<const QuantizedType*>(Args.Source1));
+	}
+
+	// Compare on the grid, movement that only differs below the quantization is not worth a send
+	QuantizedType Value0;
+	QuantizedType Value1;
+	QuantizeMovement(*reinterpret_cast<const SourceType*>(Args.Source0), Value0);
+	QuantizeMovement(*reinterpret_cast<const SourceType*>(Args.Source1), Value1);
+	return IsQuantizedEqual(Value0, Value1);
+}
+
+bool FRepMovementPhysicsNetSerializer::Validate(FNetSerializationContext& Context, const FNetValidateArgs& Args)
+{
+	const SourceType& Source = *reinterpret_cast<const SourceType*>(Args.Source);
+
+	return (uint8)Source.RotationPrecision <= (uint8)ERepPhysicsRotationPrecision::High
+		&& (uint8)Source.LocationQuantizationLevel <= (uint8)EVectorQuantization::RoundTwoDecimals
+		&& Source.LinearVelocityRangeExponent < (1 << ReplicatedPhysicsQuantization::RangeExponentBits)
+		&& Source.AngularVelocityRangeExponent < (1 << ReplicatedPhysicsQuantization::RangeExponentBits)
+		&& !Source.Location.ContainsNaN()
+		&& !Source.Rotation.ContainsNaN();
+}
+
+// Makes Iris use the serializer above for FRepMovementPhysics properties instead of bridging its NetSerialize
+static const FName PropertyNetSerializerRegistry_NAME_RepMovementPhysics("RepMovementPhysics");
+UE_NET_IMPLEMENT_NAMED_STRUCT_NETSERIALIZER_INFO(PropertyNetSerializerRegistry_NAME_RepMovementPhysics, FRepMovementPhysicsNetSerializer);
+
+class FRepMovementPhysicsNetSerializerRegistryDelegates final : private FNetSerializerRegistryDelegates
+{
+public:
+	virtual ~FRepMovementPhysicsNetSerializerRegistryDelegates();
+
+private:
+	virtual void OnPreFreezeNetSerializerRegistry() override;
+};
+
+static FRepMovementPhysicsNetSerializerRegistryDelegates RepMovementPhysicsNetSerializerRegistryDelegates;
+
+FRepMovementPhysicsNetSerializerRegistryDelegates::~FRepMovementPhysicsNetSerializerRegistryDelegates()
+{
+	UE_NET_UNREGISTER_NETSERIALIZER_INFO(PropertyNetSerializerRegistry_NAME_RepMovementPhysics);
+}
+
+void FRepMovementPhysicsNetSerializerRegistryDelegates::OnPreFreezeNetSerializerRegistry()
+{
+	UE_NET_REGISTER_NETSERIALIZER_INFO(PropertyNetSerializerRegistry_NAME_RepMovementPhysics);
+}
+
+}
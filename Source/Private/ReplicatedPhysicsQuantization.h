@@ -0,0 +1,159 @@
+// Copyright Hitbox Games, LLC. All Rights Reserved.
+
+#pragma once
+
+#include "ReplicatedPhysics.h"
+
+// Quantization of FRepMovementPhysics shared by its NetSerialize and its Iris NetSerializer so both produce the same values
+namespace ReplicatedPhysicsQuantization
+{
+	static constexpr int32 RangeExponentBits = 5;
+	static constexpr int32 VelocityComponentBits = 16;
+	static constexpr int32 VelocityComponentMax = (1 << (VelocityComponentBits - 1)) - 1;
+
+	// Bits of the bit count in front of a packed int, enough to say 0 to 32
+	static constexpr uint32 PackedBitCountBits = 6;
+
+	inline int32 GetRotationComponentBits(ERepPhysicsRotationPrecision Precision)
+	{
+		switch (Precision)
+		{
+		case ERepPhysicsRotationPrecision::Low:
+			return 9;
+		case ERepPhysicsRotationPrecision::High:
+			return 15;
+		default:
+			return 11;
+		}
+	}
+
+	inline uint8 GetRangeExponent(float MaxValue)
+	{
+		return (uint8)FMath::Clamp(FMath::CeilToInt32(FMath::Log2(FMath::Max(MaxValue, 1.f))), 0, (1 << RangeExponentBits) - 1);
+	}
+
+	// Drops the largest component of the unit quaternion, the other three are within +-1/sqrt(2)
+	inline void QuantizeSmallestThree(const FRotator& Rotation, int32 ComponentBits, uint8& OutLargestIndex, uint32 OutComponents[3])
+	{
+		const uint32 ComponentMax = (1u << ComponentBits) - 1;
+
+		FQuat Quat = Rotation.Quaternion();
+		Quat.Normalize();
+
+		const float Components[4] = { (float)Quat.X, (float)Quat.Y, (float)Quat.Z, (float)Quat.W };
+		OutLargestIndex = 0;
+		for (uint8 i = 1; i < 4; ++i)
+		{
+			if (FMath::Abs(Components[i]) > FMath::Abs(Components[OutLargestIndex]))
+			{
+				OutLargestIndex = i;
+			}
+		}
+
+		// q and -q are the same rotation, flip so the dropped component is positive
+		const float Sign = Components[OutLargestIndex] < 0.f ? -1.f : 1.f;
+
+		int32 OutIndex = 0;
+		for (uint8 i = 0; i < 4; ++i)
+		{
+			if (i != OutLargestIndex)
+			{
+				const float Normalized = FMath::Clamp(Components[i] * Sign / UE_INV_SQRT_2, -1.f, 1.f) * 0.5f + 0.5f;
+				OutComponents[OutIndex++] = (uint32)FMath::RoundToInt32(Normalized * ComponentMax);
+			}
+		}
+	}
+
+	inline FRotator DequantizeSmallestThree(uint8 LargestIndex, const uint32 Components[3], int32 ComponentBits)
+	{
+		const uint32 ComponentMax = (1u << ComponentBits) - 1;
+
+		float Values[4];
+		float SumSquares = 0.f;
+		int32 InIndex = 0;
+		for (uint8 i = 0; i < 4; ++i)
+		{
+			if (i != LargestIndex)
+			{
+				Values[i] = ((float)Components[InIndex++] / ComponentMax * 2.f - 1.f) * UE_INV_SQRT_2;
+				SumSquares += FMath::Square(Values[i]);
+			}
+		}
+
+		Values[LargestIndex & 3] = FMath::Sqrt(FMath::Max(1.f - SumSquares, 0.f));
+		FQuat Quat(Values[0], Values[1], Values[2], Values[3]);
+		Quat.Normalize();
+		return Quat.Rotator();
+	}
+
+	// Symmetric around zero so that a resting axis stays exactly zero
+	inline uint16 QuantizeBoundedComponent(float Value, uint8 RangeExponent)
+	{
+		// NaN is sent as a resting axis, infinities saturate to the end of the range
+		if (!FMath::IsFinite(Value))
+		{
+			return FMath::IsNaN(Value) ? (uint16)VelocityComponentMax : (Value > 0.f ? (uint16)(2 * VelocityComponentMax) : (uint16)0);
+		}
+
+		const float Range = (float)(1u << RangeExponent);
+		return (uint16)(FMath::RoundToInt32(FMath::Clamp(Value / Range, -1.f, 1.f) * VelocityComponentMax) + VelocityComponentMax);
+	}
+
+	inline float DequantizeBoundedComponent(uint16 Quantized, uint8 RangeExponent)
+	{
+		const float Range = (float)(1u << RangeExponent);
+		return ((int32)Quantized - VelocityComponentMax) * Range / VelocityComponentMax;
+	}
+
+	// Rounds to the grid of the quantization level and saturates to int32, non-finite values are sent as zero
+	inline int32 QuantizeLocationComponent(double Value, float Scale)
+	{
+		if (!FMath::IsFinite(Value))
+			return 0;
+
+		return (int32)FMath::RoundToInt64(FMath::Clamp(Value * Scale, (double)MIN_int32, (double)MAX_int32));
+	}
+
+	// Large worlds go past the int32 grid (about 214 km at two decimals), those locations are sent as full precision doubles
+	// Non-finite components stay on the grid, where they are sent as zero
+	inline bool IsLocationOnGrid(const FVector& Location, float Scale)
+	{
+		const double Limit = (double)MAX_int32 / Scale;
+		for (int32 i = 0; i < 3; ++i)
+		{
+			if (FMath::IsFinite(Location[i]) && FMath::Abs(Location[i]) > Limit)
+				return false;
+		}
+
+		return true;
+	}
+
+	// Zig zag keeps small negative values small, packed ints are the significant bit count followed by the bits
+	inline uint32 ZigZagEncode(int32 Value)
+	{
+		return ((uint32)Value << 1) ^ (uint32)(Value >> 31);
+	}
+
+	inline int32 ZigZagDecode(uint32 Encoded)
+	{
+		return (int32)(Encoded >> 1) ^ -(int32)(Encoded & 1);
+	}
+
+	inline uint32 GetPackedIntBits(uint32 Encoded)
+	{
+		return 32 - FMath::CountLeadingZeros(Encoded);
+	}
+
+	inline float GetLocationScale(EVectorQuantization QuantizationLevel)
+	{
+		switch (QuantizationLevel)
+		{
+		case EVectorQuantization::RoundWholeNumber:
+			return 1.f;
+		case EVectorQuantization::RoundOneDecimal:
+			return 10.f;
+		default:
+			return 100.f;
+		}
+	}
+}
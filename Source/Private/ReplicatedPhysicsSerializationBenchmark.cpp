@@ -0,0 +1,612 @@
+// Copyright Hitbox Games, LLC. All Rights Reserved.
+
+#include "IReplicatedPhysicsModule.h"
+#include "RepPhysicsAttachmentWithWeld.h"
+#include "ReplicatedPhysics.h"
+#include "ReplicatedPhysicsQuantization.h"
+#include "HAL/FileManager.h"
+#include "Math/RandomStream.h"
+#include "Misc/AutomationTest.h"
+#include "Misc/CommandLine.h"
+#include "Misc/DateTime.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Parse.h"
+#include "Misc/Paths.h"
+#include "Serialization/BitReader.h"
+#include "Serialization/BitWriter.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace ReplicatedPhysicsSerializationBenchmark
+{
+	struct FSerializationResult
+	{
+		int32 NumSamples = 0;
+		int64 TotalBits = 0;
+		double SerializeNs = 0.0;
+		double DeserializeNs = 0.0;
+		double MaxLocationError = 0.0;
+		double MaxRotationErrorDeg = 0.0;
+		double MaxLinearVelocityError = 0.0;
+		double MaxAngularVelocityError = 0.0;
+		int32 NumFailedWrites = 0;
+		int32 NumFailedReads = 0;
+	};
+
+	// Worst error each setting may round trip with, anything above it is a quantization bug
+	struct FErrorBounds
+	{
+		double Location = 0.0;
+		double RotationDeg = 0.0;
+		double LinearVelocity = 0.0;
+		double AngularVelocity = 0.0;
+	};
+
+	// Float noise on top of the quantization steps, conversions through FQuat and FRotator alone are in the order of 1e-4 deg
+	static constexpr double ErrorSlack = 0.01;
+
+	static double GetRotationErrorDeg(const FRotator& A, const FRotator& B)
+	{
+		return FMath::RadiansToDegrees(A.Quaternion().AngularDistance(B.Quaternion()));
+	}
+
+	static void TestResult(FAutomationTestBase& Test, const TCHAR* StructName, const FString& Setting, const FSerializationResult& Result, const FErrorBounds& Bounds)
+	{
+		const FString What = FString::Printf(TEXT("%s %s"), StructName, *Setting);
+		Test.TestEqual(What + TEXT(" failed writes"), Result.NumFailedWrites, 0);
+		Test.TestEqual(What + TEXT(" failed reads"), Result.NumFailedReads, 0);
+		Test.TestTrue(FString::Printf(TEXT("%s location error %.4f within %.4f"), *What, Result.MaxLocationError, Bounds.Location), Result.MaxLocationError <= Bounds.Location);
+		Test.TestTrue(FString::Printf(TEXT("%s rotation error %.4f deg within %.4f"), *What, Result.MaxRotationErrorDeg, Bounds.RotationDeg), Result.MaxRotationErrorDeg <= Bounds.RotationDeg);
+		Test.TestTrue(FString::Printf(TEXT("%s linear error %.4f within %.4f"), *What, Result.MaxLinearVelocityError, Bounds.LinearVelocity), Result.MaxLinearVelocityError <= Bounds.LinearVelocity);
+		Test.TestTrue(FString::Printf(TEXT("%s angular error %.4f within %.4f"), *What, Result.MaxAngularVelocityError, Bounds.AngularVelocity), Result.MaxAngularVelocityError <= Bounds.AngularVelocity);
+	}
+
+	static void AddResult(FString& Csv, const TCHAR* StructName, const FString& Setting, const FSerializationResult& Result)
+	{
+		const double BitsPerUpdate = (double)Result.TotalBits / FMath::Max(Result.NumSamples, 1);
+
+		Csv += FString::Printf(TEXT("%s,%s,%d,%.2f,%.2f,%.2f,%.4f,%.4f,%.4f,%.4f,%d\n"), StructName, *Setting, Result.NumSamples, BitsPerUpdate, Result.SerializeNs, Result.DeserializeNs,
+			Result.MaxLocationError, Result.MaxRotationErrorDeg, Result.MaxLinearVelocityError, Result.MaxAngularVelocityError, Result.NumFailedReads);
+
+		UE_LOG(LogReplicatedPhysics, Display, TEXT("  %-28s %-24s %7.2f bits  %8.2f ns ser  %8.2f ns deser  loc %.4f  rot %.4f deg  vel %.4f  angvel %.4f  failed %d"),
+			StructName, *Setting, BitsPerUpdate, Result.SerializeNs, Result.DeserializeNs, Result.MaxLocationError, Result.MaxRotationErrorDeg, Result.MaxLinearVelocityError, Result.MaxAngularVelocityError, Result.NumFailedReads);
+	}
+
+	// Round trips every sample, timing both directions over the set number of passes and tracking the worst error
+	template<typename StructType, typename ErrorFunctionType>
+	static FSerializationResult RoundTrip(const TArray<StructType>& Samples, int32 NumPasses, ErrorFunctionType&& AccumulateError)
+	{
+		FSerializationResult Result;
+		Result.NumSamples = Samples.Num();
+
+		TArray<TArray<uint8>> Payloads;
+		TArray<int64> PayloadBits;
+		Payloads.SetNum(Samples.Num());
+		PayloadBits.SetNum(Samples.Num());
+
+		FBitWriter Writer(1024, true);
+		for (int32 i = 0; i < Samples.Num(); ++i)
+		{
+			Writer.Reset();
+			bool bSuccess = true;
+			StructType Sample = Samples[i];
+			Sample.NetSerialize(Writer, nullptr, bSuccess);
+			if (!bSuccess || Writer.IsError())
+			{
+				++Result.NumFailedWrites;
+			}
+
+			Payloads[i] = *Writer.GetBuffer();
+			PayloadBits[i] = Writer.GetNumBits();
+			Result.TotalBits += Writer.GetNumBits();
+		}
+
+		const double SerializeStart = FPlatformTime::Seconds();
+		for (int32 Pass = 0; Pass < NumPasses; ++Pass)
+		{
+			for (const StructType& Sample : Samples)
+			{
+				Writer.Reset();
+				bool bSuccess = true;
+				StructType Copy = Sample;
+				Copy.NetSerialize(Writer, nullptr, bSuccess);
+			}
+		}
+
+		const int32 NumOps = FMath::Max(Samples.Num() * NumPasses, 1);
+		Result.SerializeNs = (FPlatformTime::Seconds() - SerializeStart) * 1.0e9 / NumOps;
+
+		const double DeserializeStart = FPlatformTime::Seconds();
+		for (int32 Pass = 0; Pass < NumPasses; ++Pass)
+		{
+			for (int32 i = 0; i < Samples.Num(); ++i)
+			{
+				FBitReader Reader(Payloads[i].GetData(), PayloadBits[i]);
+				bool bSuccess = true;
+				StructType Received = Samples[i];
+				Received.NetSerialize(Reader, nullptr, bSuccess);
+			}
+		}
+
+		Result.DeserializeNs = (FPlatformTime::Seconds() - DeserializeStart) * 1.0e9 / NumOps;
+
+		for (int32 i = 0; i < Samples.Num(); ++i)
+		{
+			// The receiver keeps its own quantization settings, so it starts from a copy of the sent state
+			FBitReader Reader(Payloads[i].GetData(), PayloadBits[i]);
+			bool bSuccess = true;
+			StructType Received = Samples[i];
+			Received.NetSerialize(Reader, nullptr, bSuccess);
+
+			if (!bSuccess || Reader.IsError())
+			{
+				++Result.NumFailedReads;
+				continue;
+			}
+
+			AccumulateError(Samples[i], Received, Result);
+		}
+
+		return Result;
+	}
+
+	static FRepMovementPhysics MakeMovement(const FVector& Location, const FRotator& Rotation, const FVector& LinearVelocity, const FVector& AngularVelocity, bool bRepPhysics)
+	{
+		FRepMovementPhysics Movement;
+		Movement.Location = Location;
+		Movement.Rotation = Rotation;
+		Movement.LinearVelocity = LinearVelocity;
+		Movement.AngularVelocity = AngularVelocity;
+		Movement.bRepPhysics = bRepPhysics;
+		return Movement;
+	}
+
+	// Recorded states are lines of X,Y,Z,Pitch,Yaw,Roll,VX,VY,VZ,AX,AY,AZ
+	static void LoadRecordedMovements(const FString& Path, TArray<FRepMovementPhysics>& OutMovements)
+	{
+		TArray<FString> Lines;
+		if (!FFileHelper::LoadFileToStringArray(Lines, *Path))
+		{
+			UE_LOG(LogReplicatedPhysics, Warning, TEXT("Failed to read recorded states from %s"), *Path);
+			return;
+		}
+
+		for (const FString& Line : Lines)
+		{
+			TArray<FString> Values;
+			Line.ParseIntoArray(Values, TEXT(","));
+			if (Values.Num() < 12 || !Values[0].IsNumeric())
+				continue;
+
+			auto Value = [&Values](int32 Index) { return FCString::Atod(*Values[Index]); };
+			OutMovements.Add(MakeMovement(FVector(Value(0), Value(1), Value(2)), FRotator(Value(3), Value(4), Value(5)), FVector(Value(6), Value(7), Value(8)), FVector(Value(9), Value(10), Value(11)), true));
+		}
+	}
+
+	// A tumbling throw sampled at 120 Hz stands in for a recording when none is passed in
+	static void MakeThrowMovements(FRandomStream& Random, TArray<FRepMovementPhysics>& OutMovements)
+	{
+		for (int32 Throw = 0; Throw < 16; ++Throw)
+		{
+			const FVector StartLocation = Random.GetUnitVector() * Random.FRandRange(0.f, 50000.f);
+			const FVector StartVelocity = Random.GetUnitVector() * Random.FRandRange(200.f, 3000.f);
+			const FVector AngularVelocity = Random.GetUnitVector() * Random.FRandRange(0.f, 1080.f);
+			const FVector Gravity(0.f, 0.f, -980.f);
+
+			FQuat Rotation = Random.GetUnitVector().ToOrientationQuat();
+			for (int32 Step = 0; Step < 240; ++Step)
+			{
+				const float Time = Step / 120.f;
+				const FVector AngularVelocityRad = FMath::DegreesToRadians(AngularVelocity);
+				Rotation = FQuat(AngularVelocityRad.GetSafeNormal(), AngularVelocityRad.Size() / 120.f) * Rotation;
+
+				OutMovements.Add(MakeMovement(StartLocation + StartVelocity * Time + 0.5f * Gravity * Time * Time, Rotation.Rotator(), StartVelocity + Gravity * Time, AngularVelocity, true));
+			}
+		}
+	}
+
+	static void MakeRandomMovements(FRandomStream& Random, int32 NumSamples, TArray<FRepMovementPhysics>& OutMovements)
+	{
+		for (int32 i = 0; i < NumSamples; ++i)
+		{
+			FRepMovementPhysics Movement = MakeMovement(
+				FVector(Random.FRandRange(-100000.f, 100000.f), Random.FRandRange(-100000.f, 100000.f), Random.FRandRange(-10000.f, 10000.f)),
+				FRotator(Random.FRandRange(-90.f, 90.f), Random.FRandRange(-180.f, 180.f), Random.FRandRange(-180.f, 180.f)),
+				Random.GetUnitVector() * Random.FRandRange(0.f, 5000.f),
+				Random.GetUnitVector() * Random.FRandRange(0.f, 1440.f),
+				Random.FRand() < 0.8f);
+
+			// Resting bodies are a good share of real traffic
+			if (Random.FRand() < 0.1f)
+			{
+				Movement.LinearVelocity = FVector::ZeroVector;
+				Movement.AngularVelocity = FVector::ZeroVector;
+				Movement.bSimulatedPhysicSleep = true;
+			}
+
+			OutMovements.Add(Movement);
+		}
+	}
+
+	// Locations out to 10000 km, past the int32 grid of every quantization level, with the odd one still on it
+	static void MakeLargeWorldMovements(FRandomStream& Random, int32 NumSamples, TArray<FRepMovementPhysics>& OutMovements)
+	{
+		for (int32 i = 0; i < NumSamples; ++i)
+		{
+			FVector Location;
+			for (int32 Axis = 0; Axis < 3; ++Axis)
+			{
+				const double Magnitude = FMath::Pow(10.0, (double)Random.FRandRange(5.f, 9.f));
+				Location[Axis] = Random.FRand() < 0.5f ? -Magnitude : Magnitude;
+			}
+
+			OutMovements.Add(MakeMovement(Location,
+				FRotator(Random.FRandRange(-90.f, 90.f), Random.FRandRange(-180.f, 180.f), Random.FRandRange(-180.f, 180.f)),
+				Random.GetUnitVector() * Random.FRandRange(0.f, 5000.f),
+				Random.GetUnitVector() * Random.FRandRange(0.f, 1440.f),
+				true));
+		}
+	}
+
+	// Half a step of every quantized component, summed over the three of a vector
+	static FErrorBounds GetMovementErrorBounds(const FRepMovementPhysics& Settings)
+	{
+		using namespace ReplicatedPhysicsQuantization;
+
+		// Smallest three components are off by at most half a step, rebuilding the dropped one and renormalizing at most
+		// triples that, and the angle between two close unit quaternions is twice their distance
+		const double RotationStep = UE_INV_SQRT_2 / ((1 << GetRotationComponentBits(Settings.RotationPrecision)) - 1);
+
+		FErrorBounds Bounds;
+		Bounds.Location = UE_SQRT_3 * 0.5 / GetLocationScale(Settings.LocationQuantizationLevel) + ErrorSlack;
+		Bounds.RotationDeg = FMath::RadiansToDegrees(8.0 * RotationStep) + ErrorSlack;
+		Bounds.LinearVelocity = UE_SQRT_3 * 0.5 * (1 << Settings.LinearVelocityRangeExponent) / VelocityComponentMax + ErrorSlack;
+		Bounds.AngularVelocity = UE_SQRT_3 * 0.5 * (1 << Settings.AngularVelocityRangeExponent) / VelocityComponentMax + ErrorSlack;
+		return Bounds;
+	}
+
+	static void RunMovementBenchmarks(FAutomationTestBase& Test, FString& Csv, const TArray<FRepMovementPhysics>& BaseSamples, const TCHAR* SampleSetName, int32 NumPasses)
+	{
+		static const TPair<EVectorQuantization, const TCHAR*> LocationLevels[] = {
+			{ EVectorQuantization::RoundWholeNumber, TEXT("Loc1") },
+			{ EVectorQuantization::RoundOneDecimal, TEXT("Loc10") },
+			{ EVectorQuantization::RoundTwoDecimals, TEXT("Loc100") } };
+
+		static const TPair<ERepPhysicsRotationPrecision, const TCHAR*> RotationLevels[] = {
+			{ ERepPhysicsRotationPrecision::Low, TEXT("RotLow") },
+			{ ERepPhysicsRotationPrecision::Medium, TEXT("RotMedium") },
+			{ ERepPhysicsRotationPrecision::High, TEXT("RotHigh") } };
+
+		for (const TPair<EVectorQuantization, const TCHAR*>& LocationLevel : LocationLevels)
+		{
+			for (const TPair<ERepPhysicsRotationPrecision, const TCHAR*>& RotationLevel : RotationLevels)
+			{
+				TArray<FRepMovementPhysics> Samples = BaseSamples;
+				for (FRepMovementPhysics& Sample : Samples)
+				{
+					Sample.LocationQuantizationLevel = LocationLevel.Key;
+					Sample.SetEncodingSettings(5000.f, 1440.f, RotationLevel.Key);
+				}
+
+				const FSerializationResult Result = RoundTrip(Samples, NumPasses, [](const FRepMovementPhysics& Sent, const FRepMovementPhysics& Received, FSerializationResult& OutResult)
+				{
+					OutResult.MaxLocationError = FMath::Max(OutResult.MaxLocationError, FVector::Dist(Sent.Location, Received.Location));
+					OutResult.MaxRotationErrorDeg = FMath::Max(OutResult.MaxRotationErrorDeg, GetRotationErrorDeg(Sent.Rotation, Received.Rotation));
+					OutResult.MaxLinearVelocityError = FMath::Max(OutResult.MaxLinearVelocityError, FVector::Dist(Sent.LinearVelocity, Received.LinearVelocity));
+					if (Sent.bRepPhysics)
+					{
+						OutResult.MaxAngularVelocityError = FMath::Max(OutResult.MaxAngularVelocityError, FVector::Dist(Sent.AngularVelocity, Received.AngularVelocity));
+					}
+				});
+
+				const FString Setting = FString::Printf(TEXT("%s %s %s"), SampleSetName, LocationLevel.Value, RotationLevel.Value);
+				AddResult(Csv, TEXT("FRepMovementPhysics"), Setting, Result);
+				TestResult(Test, TEXT("FRepMovementPhysics"), Setting, Result, GetMovementErrorBounds(Samples[0]));
+			}
+		}
+	}
+
+	// Client auth updates encoded against the previous sample the way an acked baseline is used, rebuilt on the receiving end
+	// The rebuilt movement has to land on the same grid as FRepMovementPhysics with the client auth defaults
+	static void RunClientAuthDeltaRoundTrip(FAutomationTestBase& Test, FString& Csv, const TArray<FRepMovementPhysics>& BaseSamples, const TCHAR* SampleSetName)
+	{
+		const FPhysicsClientAuthReplicationData Defaults;
+
+		FSerializationResult Result;
+		Result.NumSamples = BaseSamples.Num();
+
+		FBitWriter Writer(1024, true);
+		FQuantizedPhysicsState SentBaseline;
+		FQuantizedPhysicsState ReceivedBaseline;
+		for (int32 i = 0; i < BaseSamples.Num(); ++i)
+		{
+			FRepMovementPhysics Sent = BaseSamples[i];
+			Sent.LocationQuantizationLevel = EVectorQuantization::RoundTwoDecimals;
+			Sent.SetEncodingSettings(Defaults.MaxReplicatedLinearSpeed, Defaults.MaxReplicatedAngularSpeed, Defaults.MovementRotationPrecision);
+
+			FQuantizedPhysicsState State;
+			State.FromMovement(Sent);
+
+			FRepClientAuthMovement Update;
+			Update.Sequence = (uint16)i;
+			Update.BaselineSequence = (uint16)(i - 1);
+			Update.bIsFullState = i == 0;
+			Update.State = Update.bIsFullState ? State : State.GetDeltaFrom(SentBaseline);
+			SentBaseline = State;
+
+			Writer.Reset();
+			bool bSuccess = true;
+			Update.NetSerialize(Writer, nullptr, bSuccess);
+			Result.TotalBits += Writer.GetNumBits();
+			if (!bSuccess || Writer.IsError())
+			{
+				++Result.NumFailedWrites;
+				continue;
+			}
+
+			FBitReader Reader(Writer.GetData(), Writer.GetNumBits());
+			FRepClientAuthMovement Received;
+			Received.NetSerialize(Reader, nullptr, bSuccess);
+			if (!bSuccess || Reader.IsError())
+			{
+				++Result.NumFailedReads;
+				continue;
+			}
+
+			ReceivedBaseline = Received.bIsFullState ? Received.State : ReceivedBaseline.AddDelta(Received.State);
+
+			FRepMovementPhysics Rebuilt;
+			ReceivedBaseline.ToMovement(Rebuilt);
+			Result.MaxLocationError = FMath::Max(Result.MaxLocationError, FVector::Dist(Sent.Location, Rebuilt.Location));
+			Result.MaxRotationErrorDeg = FMath::Max(Result.MaxRotationErrorDeg, GetRotationErrorDeg(Sent.Rotation, Rebuilt.Rotation));
+			Result.MaxLinearVelocityError = FMath::Max(Result.MaxLinearVelocityError, FVector::Dist(Sent.LinearVelocity, Rebuilt.LinearVelocity));
+			Result.MaxAngularVelocityError = FMath::Max(Result.MaxAngularVelocityError, FVector::Dist(Sent.AngularVelocity, Rebuilt.AngularVelocity));
+		}
+
+		FRepMovementPhysics Settings;
+		Settings.LocationQuantizationLevel = EVectorQuantization::RoundTwoDecimals;
+		Settings.SetEncodingSettings(Defaults.MaxReplicatedLinearSpeed, Defaults.MaxReplicatedAngularSpeed, Defaults.MovementRotationPrecision);
+
+		AddResult(Csv, TEXT("FRepClientAuthMovement"), SampleSetName, Result);
+		TestResult(Test, TEXT("FRepClientAuthMovement"), SampleSetName, Result, GetMovementErrorBounds(Settings));
+	}
+
+	// Object references are left null, without a package map they are not written
+	static void MakeRandomAttachments(FRandomStream& Random, int32 NumSamples, TArray<FRepPhysicsAttachmentWithWeld>& OutAttachments)
+	{
+		for (int32 i = 0; i < NumSamples; ++i)
+		{
+			FRepPhysicsAttachmentWithWeld Attachment;
+			Attachment.bIsWelded = Random.FRand() < 0.5f;
+			Attachment.LocationOffset = Random.GetUnitVector() * Random.FRandRange(0.f, 200.f);
+			Attachment.RotationOffset = Random.FRand() < 0.5f ? FRotator::ZeroRotator : FRotator(Random.FRandRange(-90.f, 90.f), Random.FRandRange(-180.f, 180.f), Random.FRandRange(-180.f, 180.f));
+
+			// Mostly unit scale, then uniform, then the odd non uniform one
+			const float ScaleRoll = Random.FRand();
+			Attachment.RelativeScale3D = ScaleRoll < 0.7f ? FVector::OneVector : (ScaleRoll < 0.9f ? FVector(Random.FRandRange(0.1f, 4.f)) : FVector(Random.FRandRange(0.1f, 4.f), Random.FRandRange(0.1f, 4.f), Random.FRandRange(0.1f, 4.f)));
+			Attachment.AttachSocket = Random.FRand() < 0.3f ? FName(TEXT("hand_r")) : NAME_None;
+			OutAttachments.Add(Attachment);
+		}
+	}
+
+	static void RunAttachmentBenchmark(FAutomationTestBase& Test, FString& Csv, const TArray<FRepPhysicsAttachmentWithWeld>& Samples, int32 NumPasses)
+	{
+		const FSerializationResult Result = RoundTrip(Samples, NumPasses, [](const FRepPhysicsAttachmentWithWeld& Sent, const FRepPhysicsAttachmentWithWeld& Received, FSerializationResult& OutResult)
+		{
+			OutResult.MaxLocationError = FMath::Max(OutResult.MaxLocationError, FVector::Dist(Sent.LocationOffset, Received.LocationOffset));
+			OutResult.MaxRotationErrorDeg = FMath::Max(OutResult.MaxRotationErrorDeg, GetRotationErrorDeg(Sent.RotationOffset, Received.RotationOffset));
+
+			// Reported in the linear velocity column, the attachment has no velocities
+			OutResult.MaxLinearVelocityError = FMath::Max(OutResult.MaxLinearVelocityError, FVector::Dist(Sent.RelativeScale3D, Received.RelativeScale3D));
+		});
+
+		AddResult(Csv, TEXT("FRepPhysicsAttachmentWithWeld"), TEXT("Random"), Result);
+
+		// Offsets are sent at full precision, rotations as 16 bit shorts and scales in steps of 1/1000th
+		FErrorBounds Bounds;
+		Bounds.Location = ErrorSlack;
+		Bounds.RotationDeg = 3.0 * 0.5 * 360.0 / 65536.0 + ErrorSlack;
+		Bounds.LinearVelocity = UE_SQRT_3 * 0.001 + ErrorSlack;
+		TestResult(Test, TEXT("FRepPhysicsAttachmentWithWeld"), TEXT("Random"), Result, Bounds);
+	}
+
+	// Feeds random and truncated payloads through the readers, a safe read either flags an error or yields finite values
+	template<typename StructType, typename IsFiniteFunctionType>
+	static void FuzzReads(FAutomationTestBase& Test, const TCHAR* StructName, FRandomStream& Random, const TArray<StructType>& ValidSamples, int32 NumInputs, IsFiniteFunctionType&& IsFinite)
+	{
+		int32 NumUnsafe = 0;
+		int32 NumErrors = 0;
+
+		// Nothing at all to read has to be an error, not a default constructed value
+		{
+			FBitReader EmptyReader(nullptr, 0);
+			bool bSuccess = true;
+			StructType Received;
+			Received.NetSerialize(EmptyReader, nullptr, bSuccess);
+			Test.TestTrue(FString::Printf(TEXT("%s empty payload is an error"), StructName), EmptyReader.IsError() || !bSuccess);
+		}
+
+		FBitWriter Writer(1024, true);
+		TArray<uint8> Bytes;
+		for (int32 i = 0; i < NumInputs; ++i)
+		{
+			int64 NumBits = 0;
+			if (ValidSamples.Num() > 0 && (i & 1))
+			{
+				// A valid payload cut short or with flipped bits
+				Writer.Reset();
+				bool bWriteSuccess = true;
+				StructType Sample = ValidSamples[Random.RandHelper(ValidSamples.Num())];
+				Sample.NetSerialize(Writer, nullptr, bWriteSuccess);
+
+				Bytes = *Writer.GetBuffer();
+				NumBits = Random.RandRange(0, (int32)Writer.GetNumBits());
+				for (int32 Flip = Random.RandRange(0, 4); Flip > 0 && Bytes.Num() > 0; --Flip)
+				{
+					Bytes[Random.RandHelper(Bytes.Num())] ^= (uint8)(1 << Random.RandHelper(8));
+				}
+			}
+			else
+			{
+				Bytes.SetNum(Random.RandRange(0, 64));
+				for (uint8& Byte : Bytes)
+				{
+					Byte = (uint8)Random.RandHelper(256);
+				}
+
+				NumBits = Bytes.Num() * 8;
+			}
+
+			FBitReader Reader(Bytes.GetData(), NumBits);
+			bool bSuccess = true;
+			StructType Received;
+			Received.NetSerialize(Reader, nullptr, bSuccess);
+
+			if (!bSuccess || Reader.IsError())
+			{
+				++NumErrors;
+			}
+			else if (!IsFinite(Received))
+			{
+				++NumUnsafe;
+			}
+		}
+
+		UE_LOG(LogReplicatedPhysics, Display, TEXT("    %s: %d inputs, %d flagged as errors, %d read without an error into non finite values"), StructName, NumInputs, NumErrors, NumUnsafe);
+		Test.TestEqual(FString::Printf(TEXT("%s malformed inputs read into non finite values"), StructName), NumUnsafe, 0);
+		Test.TestTrue(FString::Printf(TEXT("%s truncated inputs are flagged as errors"), StructName), NumErrors > 0);
+	}
+
+	static void MakeSampleSets(FRandomStream& Random, int32 NumSamples, const FString& RecordedStatesPath, TArray<FRepMovementPhysics>& OutRecordedMovements,
+		TArray<FRepMovementPhysics>& OutRandomMovements, TArray<FRepMovementPhysics>& OutLargeWorldMovements, TArray<FRepPhysicsAttachmentWithWeld>& OutRandomAttachments)
+	{
+		if (!RecordedStatesPath.IsEmpty())
+		{
+			LoadRecordedMovements(RecordedStatesPath, OutRecordedMovements);
+		}
+		else
+		{
+			MakeThrowMovements(Random, OutRecordedMovements);
+		}
+
+		MakeRandomMovements(Random, NumSamples, OutRandomMovements);
+		MakeLargeWorldMovements(Random, NumSamples, OutLargeWorldMovements);
+		MakeRandomAttachments(Random, NumSamples, OutRandomAttachments);
+	}
+
+	static void RunRoundTrips(FAutomationTestBase& Test, FString& Csv, const TArray<FRepMovementPhysics>& RecordedMovements, const TArray<FRepMovementPhysics>& RandomMovements,
+		const TArray<FRepMovementPhysics>& LargeWorldMovements, const TArray<FRepPhysicsAttachmentWithWeld>& RandomAttachments, int32 NumPasses)
+	{
+		if (RecordedMovements.Num() > 0)
+		{
+			RunMovementBenchmarks(Test, Csv, RecordedMovements, TEXT("Recorded"), NumPasses);
+		}
+
+		RunMovementBenchmarks(Test, Csv, RandomMovements, TEXT("Random"), NumPasses);
+		RunMovementBenchmarks(Test, Csv, LargeWorldMovements, TEXT("LargeWorld"), NumPasses);
+
+		if (RecordedMovements.Num() > 0)
+		{
+			RunClientAuthDeltaRoundTrip(Test, Csv, RecordedMovements, TEXT("Recorded"));
+		}
+
+		RunAttachmentBenchmark(Test, Csv, RandomAttachments, NumPasses);
+	}
+
+	static const TCHAR* CsvHeader = TEXT("Struct,Setting,Samples,BitsPerUpdate,SerializeNs,DeserializeNs,MaxLocationError,MaxRotationErrorDeg,MaxLinearVelocityError,MaxAngularVelocityError,FailedReads\n");
+	static constexpr uint32 RandomSeed = 0x52504859;
+}
+
+// Every movement setting and the attachment round trip within half a quantization step of what was sent
+// Large world locations past the int32 grid have to come back at full precision
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FReplicatedPhysicsSerializationRoundTripTest, "ReplicatedPhysics.Serialization.RoundTrip",
+	EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FReplicatedPhysicsSerializationRoundTripTest::RunTest(const FString& Parameters)
+{
+	using namespace ReplicatedPhysicsSerializationBenchmark;
+
+	FRandomStream Random(RandomSeed);
+	TArray<FRepMovementPhysics> ThrowMovements;
+	TArray<FRepMovementPhysics> RandomMovements;
+	TArray<FRepMovementPhysics> LargeWorldMovements;
+	TArray<FRepPhysicsAttachmentWithWeld> RandomAttachments;
+	MakeSampleSets(Random, 2000, FString(), ThrowMovements, RandomMovements, LargeWorldMovements, RandomAttachments);
+
+	FString Csv;
+	RunRoundTrips(*this, Csv, ThrowMovements, RandomMovements, LargeWorldMovements, RandomAttachments, 1);
+	return true;
+}
+
+// Malformed input either fails the read or reads into finite values, never into NaN or infinities
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FReplicatedPhysicsSerializationFuzzTest, "ReplicatedPhysics.Serialization.Fuzz",
+	EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FReplicatedPhysicsSerializationFuzzTest::RunTest(const FString& Parameters)
+{
+	using namespace ReplicatedPhysicsSerializationBenchmark;
+
+	constexpr int32 NumFuzzInputs = 20000;
+
+	FRandomStream Random(RandomSeed);
+	TArray<FRepMovementPhysics> ThrowMovements;
+	TArray<FRepMovementPhysics> RandomMovements;
+	TArray<FRepMovementPhysics> LargeWorldMovements;
+	TArray<FRepPhysicsAttachmentWithWeld> RandomAttachments;
+	MakeSampleSets(Random, 1000, FString(), ThrowMovements, RandomMovements, LargeWorldMovements, RandomAttachments);
+
+	FuzzReads(*this, TEXT("FRepMovementPhysics"), Random, RandomMovements, NumFuzzInputs, [](const FRepMovementPhysics& Movement)
+	{
+		return !Movement.Location.ContainsNaN() && !Movement.Rotation.ContainsNaN() && !Movement.LinearVelocity.ContainsNaN() && !Movement.AngularVelocity.ContainsNaN();
+	});
+
+	FuzzReads(*this, TEXT("FRepPhysicsAttachmentWithWeld"), Random, RandomAttachments, NumFuzzInputs, [](const FRepPhysicsAttachmentWithWeld& Attachment)
+	{
+		return !Attachment.LocationOffset.ContainsNaN() && !Attachment.RotationOffset.ContainsNaN() && !Attachment.RelativeScale3D.ContainsNaN();
+	});
+
+	return true;
+}
+
+// Runs headless, e.g. UnrealEditor-Cmd <Project> -nullrhi -unattended -ExecCmds="Automation RunTests ReplicatedPhysics.Bench.Serialization;Quit"
+// Times the round trips over more samples and passes and writes bits per update, ns per op and the worst errors to Saved/Profiling/ReplicatedPhysics
+// A recording of X,Y,Z,Pitch,Yaw,Roll,VX,VY,VZ,AX,AY,AZ lines replaces the generated throws with -ReplicatedPhysicsRecordedStates=<Csv>
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FReplicatedPhysicsSerializationBenchmarkTest, "ReplicatedPhysics.Bench.Serialization",
+	EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+
+bool FReplicatedPhysicsSerializationBenchmarkTest::RunTest(const FString& Parameters)
+{
+	using namespace ReplicatedPhysicsSerializationBenchmark;
+
+	constexpr int32 NumSamples = 10000;
+	constexpr int32 NumPasses = 10;
+
+	FString RecordedStatesPath;
+	FParse::Value(FCommandLine::Get(), TEXT("ReplicatedPhysicsRecordedStates="), RecordedStatesPath);
+
+	FRandomStream Random(RandomSeed);
+	TArray<FRepMovementPhysics> RecordedMovements;
+	TArray<FRepMovementPhysics> RandomMovements;
+	TArray<FRepMovementPhysics> LargeWorldMovements;
+	TArray<FRepPhysicsAttachmentWithWeld> RandomAttachments;
+	MakeSampleSets(Random, NumSamples, RecordedStatesPath, RecordedMovements, RandomMovements, LargeWorldMovements, RandomAttachments);
+
+	FString Csv = CsvHeader;
+	UE_LOG(LogReplicatedPhysics, Display, TEXT("Serialization benchmark (%d random samples, %d recorded samples, %d passes)"), NumSamples, RecordedMovements.Num(), NumPasses);
+	RunRoundTrips(*this, Csv, RecordedMovements, RandomMovements, LargeWorldMovements, RandomAttachments, NumPasses);
+
+	const FString CsvPath = FPaths::Combine(FPaths::ProfilingDir(), TEXT("ReplicatedPhysics"), FString::Printf(TEXT("Serialization-%s.csv"), *FDateTime::Now().ToString()));
+	IFileManager::Get().MakeDirectory(*FPaths::GetPath(CsvPath), true);
+	if (FFileHelper::SaveStringToFile(Csv, *CsvPath))
+	{
+		UE_LOG(LogReplicatedPhysics, Display, TEXT("Wrote %s"), *CsvPath);
+	}
+	else
+	{
+		UE_LOG(LogReplicatedPhysics, Warning, TEXT("Failed to write %s"), *CsvPath);
+	}
+
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
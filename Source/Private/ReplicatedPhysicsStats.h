@@ -0,0 +1,10 @@
+// Copyright Hitbox Games, LLC. All Rights Reserved.
+
+#pragma once
+
+#include "ProfilingDebugging/CsvProfiler.h"
+#include "Stats/Stats.h"
+
+DECLARE_STATS_GROUP(TEXT("ReplicatedPhysics"), STATGROUP_ReplicatedPhysics, STATCAT_Advanced);
+
+CSV_DECLARE_CATEGORY_MODULE_EXTERN(REPLICATEDPHYSICS_API, ReplicatedPhysics);
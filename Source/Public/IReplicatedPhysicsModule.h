@@ -4,6 +4,8 @@
 
 #include "Modules/ModuleInterface.h"
 
+REPLICATEDPHYSICS_API DECLARE_LOG_CATEGORY_EXTERN(LogReplicatedPhysics, Log, All);
+
 class IReplicatedPhysicsModule : public IModuleInterface
 {
 };
@@ -2,12 +2,69 @@
 
 #pragma once
 
+#include "Engine/EngineTypes.h"
 #include "Subsystems/WorldSubsystem.h"
+#include "UObject/ObjectKey.h"
 
 #include "PhysicsBucketUpdateSubsystem.generated.h"
 
 DECLARE_DELEGATE_RetVal(bool, FPhysicsBucketUpdateTickSignature);
+// Thread safe read only stage of a two phase entry, returns if the commit stage needs to run for this fire
+DECLARE_DELEGATE_RetVal(bool, FPhysicsBucketGatherSignature);
 DECLARE_DYNAMIC_DELEGATE(FDynamicPhysicsBucketUpdateTickSignature);
+// Broadcast after every bucket update, lets callers batch up whatever the fired entries produced
+DECLARE_MULTICAST_DELEGATE(FOnPhysicsBucketsDispatched);
+
+class FPhysScene_Chaos;
+class UPrimitiveComponent;
+struct FUpdatePhysicsBucketContainer;
+
+// Handle to a single registration in the bucket container
+// Handles are never reused, a handle to a removed entry simply stops resolving
+USTRUCT(BlueprintType)
+struct REPLICATEDPHYSICS_API FPhysicsBucketHandle
+{
+	GENERATED_BODY()
+
+	friend struct FUpdatePhysicsBucketContainer;
+
+public:
+	FPhysicsBucketHandle() :
+		Index(INDEX_NONE),
+		Serial(0)
+	{
+	}
+
+	bool IsValid() const
+	{
+		return Index != INDEX_NONE;
+	}
+
+	void Invalidate()
+	{
+		Index = INDEX_NONE;
+		Serial = 0;
+	}
+
+	bool operator==(const FPhysicsBucketHandle& Other) const
+	{
+		return Index == Other.Index && Serial == Other.Serial;
+	}
+
+	bool operator!=(const FPhysicsBucketHandle& Other) const
+	{
+		return !(*this == Other);
+	}
+
+	friend uint32 GetTypeHash(const FPhysicsBucketHandle& Handle)
+	{
+		return HashCombine(GetTypeHash(Handle.Index), GetTypeHash(Handle.Serial));
+	}
+
+private:
+	int32 Index;
+	uint32 Serial;
+};
 
 USTRUCT()
 struct REPLICATEDPHYSICS_API FUpdatePhysicsBucketDrop
@@ -18,8 +75,38 @@ public:
 	FPhysicsBucketUpdateTickSignature NativeCallback;
 	FDynamicPhysicsBucketUpdateTickSignature DynamicCallback;
 
+	// Optional gather stage, when bound it runs for every entry of the phase (possibly across workers) before
+	// the callbacks above run on the game thread as the commit stage
+	FPhysicsBucketGatherSignature GatherCallback;
+	bool bHasGatherStage;
+	bool bGatherNeedsCommit;
+
 	FName FunctionName;
 
+	// Registry bookkeeping, owned by the bucket container
+	// BucketKey is the period of the entry in wheel ticks, the rate it was registered with is snapped to it
+	FObjectKey BoundObject;
+	uint32 BucketKey;
+	int32 PhaseIndex;
+	int32 IndexInPhase;
+	uint32 Serial;
+	bool bIsRegistered;
+	bool bIsLinked;
+
+	// One shot entries sit in the timer wheel instead of a bucket and are removed after they fire once
+	bool bIsOneShot;
+	uint64 DeadlineTick;
+	int32 TimerSlot;
+	int32 IndexInTimerSlot;
+
+	// Weight of the entry when the frame budget runs out, overdue entries are run in order of lateness times priority
+	float Priority;
+
+	// Scheduler time that the entry became due at and how late its last fire ran, only tracked while a frame budget is set
+	double DueTime;
+	float LastLateness;
+	bool bIsQueued;
+
 	bool ExecuteBoundCallback();
 	bool IsBoundToObjectFunction(UObject* Obj, FName& FuncName);
 	bool IsBoundToObjectDelegate(FDynamicPhysicsBucketUpdateTickSignature& DynEvent);
@@ -30,26 +117,100 @@ public:
 };
 
 
+UENUM(BlueprintType)
+enum class EPhysicsBucketDispatchMode : uint8
+{
+	// Every entry in a bucket fires on the same frame once per period
+	Batched,
+
+	// Every entry is given a stable phase in its bucket and the phases are spread across the frames of the period
+	// Each entry is still polled at its requested rate, but the per frame cost stays flat instead of spiking
+	Staggered
+};
+
+USTRUCT()
+struct REPLICATEDPHYSICS_API FUpdatePhysicsBucketPhase
+{
+	GENERATED_BODY()
+
+public:
+	// Indices into the container entries
+	TArray<int32> Entries;
+
+	// Number of entries in this phase with a gather stage, the phase is fired in two phases when non zero
+	int32 NumGatherEntries = 0;
+};
+
+// Periodic slot of the timing wheel, every entry whose rate snaps to the same period shares one
 USTRUCT()
 struct REPLICATEDPHYSICS_API FUpdatePhysicsBucket
 {
 	GENERATED_BODY()
 
 public:
-	float nUpdateRate;
-	float nUpdateCount;
+	// Number of wheel ticks between two fires of the same entry
+	int32 PeriodTicks;
 
-	TArray<FUpdatePhysicsBucketDrop> Callbacks;
+	// Wheel tick the bucket was created on, its phases are laid out relative to it
+	uint64 OriginTick;
+	int32 NumEntries;
 
-	bool Update(float DeltaTime);
-	
-	FUpdatePhysicsBucket() {}
+	// Entries split by the slice of the period that they fire in, a batched bucket only has a single phase
+	TArray<FUpdatePhysicsBucketPhase> Phases;
 
-	FUpdatePhysicsBucket(uint32 UpdateHTZ) :
-		nUpdateRate(1.0f / UpdateHTZ),
-		nUpdateCount(0.0f)
+	// Per rate cycle counter, shows up as "Bucket <Rate> Hz" in the ReplicatedPhysics stat group
+	TStatId StatId;
+
+	// Fires the phases that fall on the passed in run of wheel ticks
+	bool Update(uint64 FirstTick, int32 NumTicks, FUpdatePhysicsBucketContainer& Container);
+
+	// New entries are placed in the least populated phase and keep it for as long as they are in the bucket
+	int32 GetLeastPopulatedPhase() const;
+
+	// Returns the phase that fires on the passed in wheel tick, or INDEX_NONE if none does
+	int32 GetPhaseForTick(uint64 Tick) const;
+
+	FUpdatePhysicsBucket() :
+		PeriodTicks(1),
+		OriginTick(0),
+		NumEntries(0)
 	{
 	}
+
+	FUpdatePhysicsBucket(int32 InPeriodTicks, int32 PhaseCount, uint64 InOriginTick, TStatId InStatId);
+
+private:
+	void FirePhase(int32 PhaseIndex, FUpdatePhysicsBucketContainer& Container);
+};
+
+// Counters for a single UpdateBuckets call
+struct FPhysicsBucketFrameStats
+{
+	// Callbacks that were executed
+	int32 NumFires = 0;
+
+	// Entries that were removed, either by request or because they reported completion
+	int32 NumRemovals = 0;
+
+	// Bucket phases that fell more than a full period behind and dropped fires to catch up
+	int32 NumOverruns = 0;
+
+	// Due entries that didn't fit in the frame budget and were carried over to the next update
+	int32 NumDeferred = 0;
+
+	// Largest lateness of the entries fired this update, in seconds
+	float MaxLateness = 0.0f;
+
+	// Entries removed because their object was garbage collected
+	int32 NumPurged = 0;
+};
+
+// Due entry waiting on the frame budget, the serial guards against the slot being re-used while it waits
+struct FPhysicsBucketQueuedEntry
+{
+	int32 EntryIndex;
+	uint32 Serial;
+	float Score;
 };
 
 USTRUCT()
@@ -59,32 +220,344 @@ struct REPLICATEDPHYSICS_API FUpdatePhysicsBucketContainer
 
 public:
 	bool bNeedsUpdate;
+	EPhysicsBucketDispatchMode DispatchMode;
+
+	// Periodic entries keyed by their period in wheel ticks
 	TMap<uint32, FUpdatePhysicsBucket> ReplicationBuckets;
 
+	// Resolution of the wheel, every rate is snapped to a whole number of ticks so that entries share buckets
+	float TickRate;
+	double TickAccumulator;
+	uint64 CurrentTick;
+
+	// Hierarchical wheel of one shot entries, TimerWheelLevels levels of TimerWheelSlots slots each
+	// Inserting and cancelling are constant time, deadlines past the top level are parked at its end and re-inserted
+	static constexpr int32 TimerWheelSlotBits = 6;
+	static constexpr int32 TimerWheelSlots = 1 << TimerWheelSlotBits;
+	static constexpr int32 TimerWheelLevels = 4;
+	TArray<TArray<int32>> TimerWheel;
+	TArray<int32> ScratchTimers;
+	int32 NumTimers;
+
+	// Slot map of every registration, buckets only store indices into this
+	TArray<FUpdatePhysicsBucketDrop> Entries;
+	TArray<int32> FreeEntries;
+
+	// Every entry that is registered for an object, lets the object and function based calls skip scanning the buckets
+	// Keyed weakly so that the entries of garbage collected objects can be found and purged in bulk
+	TMap<FObjectKey, TArray<int32, TInlineAllocator<2>>> ObjectEntries;
+
+	// Set while the buckets are firing, structural changes made by callbacks are queued until the fire is over
+	bool bIsDispatching;
+
+	// Registrations made while dispatching that didn't fit a free slot, appended to Entries once dispatch ends
+	TArray<FUpdatePhysicsBucketDrop> PendingEntries;
+
+	// Entries waiting to be linked into or unlinked from their bucket phase once dispatch ends
+	TArray<int32> PendingLinks;
+	TArray<int32> PendingUnlinks;
+
+	bool bHasPendingDispatchMode;
+	EPhysicsBucketDispatchMode PendingDispatchMode;
+
+	// Frame budget, when either is set due entries are queued and fired in order of lateness times priority
+	// until the budget runs out, the rest is carried over to the next update. 0 means unlimited
+	int32 MaxCallbacksPerFrame;
+	double FrameBudgetSeconds;
+
+	// Accumulated update time that due times and lateness are measured against
+	double SchedulerTime;
+
+	// Due entries waiting on the frame budget, including the ones carried over from previous updates
+	TArray<FPhysicsBucketQueuedEntry> ReadyQueue;
+	TArray<int32> ScratchBatch;
+
+	// Number of live registrations and the counters of the last UpdateBuckets call
+	int32 NumRegisteredEntries;
+	int32 NumGatherEntries;
+	FPhysicsBucketFrameStats FrameStats;
+	FPhysicsBucketFrameStats LastFrameStats;
+
+	// Bucket cycle counters by period, kept across buckets being emptied and re-created so churn doesn't allocate them again
+	TMap<uint32, TStatId> BucketStatIds;
+
 	void UpdateBuckets(float DeltaTime);
 
-	bool AddBucketObject(uint32 UpdateHTZ, UObject* InObject, FName FunctionName);
-	bool AddBucketObject(uint32 UpdateHTZ, FDynamicPhysicsBucketUpdateTickSignature& Delegate);
+	// Changes how buckets fire their callbacks, existing buckets are re-sliced to match the new mode
+	void SetDispatchMode(EPhysicsBucketDispatchMode NewDispatchMode);
+
+	// Returns the number of phases a bucket of the passed in period is split into under the current dispatch mode
+	int32 GetPhaseCountForPeriod(int32 PeriodTicks) const;
+
+	// Returns the nearest period in wheel ticks to the passed in rate, rates above the tick rate fire every tick
+	int32 GetPeriodTicksForRate(uint32 UpdateHTZ) const;
+
+	// Changes the wheel resolution, only possible while nothing is registered
+	bool SetTickRate(float NewTickRate);
+
+	// Returns the cycle counter of the bucket with the passed in period, created the first time the period is used
+	TStatId GetBucketStatId(uint32 PeriodTicks);
+
+	// Sets the per update budget, 0 for both turns the budget off and fires everything as soon as it is due
+	void SetFrameBudget(float BudgetMs, int32 MaxCallbacks);
+
+	bool HasFrameBudget() const
+	{
+		return MaxCallbacksPerFrame > 0 || FrameBudgetSeconds > 0.0;
+	}
+
+	// Queues an entry that a bucket phase just made due, entries that are still waiting keep their original due time
+	void QueueEntry(int32 EntryIndex);
+
+	// Fires queued entries in order of lateness times priority until the frame budget runs out
+	void DispatchQueuedEntries(float DeltaTime);
+
+	bool SetBucketEntryPriority(const FPhysicsBucketHandle& Handle, float NewPriority);
+
+	// Returns how late the entry's last fire ran in seconds, or how long it has been waiting if it is currently queued
+	float GetBucketEntryLateness(const FPhysicsBucketHandle& Handle) const;
+
+	// Registers the callback in the bucket with the set HTZ, returns an invalid handle if the callback isn't bound
+	FPhysicsBucketHandle AddBucketEntry(uint32 UpdateHTZ, const FUpdatePhysicsBucketDrop& Callback);
+	bool RemoveBucketEntry(const FPhysicsBucketHandle& Handle);
+	bool IsBucketEntryRegistered(const FPhysicsBucketHandle& Handle) const;
+
+	// Registers a callback that fires once after the delay and is then removed, the delay is rounded up to the next wheel tick
+	FPhysicsBucketHandle AddTimerEntry(float DelaySeconds, const FUpdatePhysicsBucketDrop& Callback);
 
-	/*
+	// Returns the seconds left until a one shot entry fires, or -1 if the handle isn't a pending one shot
+	float GetTimerRemaining(const FPhysicsBucketHandle& Handle) const;
+
+	FPhysicsBucketHandle AddBucketObject(uint32 UpdateHTZ, UObject* InObject, FName FunctionName, float Priority = 1.0f);
+	FPhysicsBucketHandle AddBucketObject(uint32 UpdateHTZ, FDynamicPhysicsBucketUpdateTickSignature& Delegate, float Priority = 1.0f);
+
+	// Registers a native member function that is called directly instead of going through UFunction reflection
+	// FunctionName is optional, when set it lets the name based calls find the entry and an existing entry with the same name is replaced
 	template<typename classType>
-	bool AddReplicatingObject(uint32 UpdateHTZ, classType* InObject, void(classType::* _Func)())
+	FPhysicsBucketHandle AddReplicatingObject(uint32 UpdateHTZ, classType* InObject, bool(classType::* InFunc)(), FName FunctionName = NAME_None, float Priority = 1.0f)
 	{
+		if (!InObject || !InFunc || UpdateHTZ < 1)
+			return FPhysicsBucketHandle();
+
+		if (!FunctionName.IsNone())
+		{
+			RemoveBucketObject(InObject, FunctionName);
+		}
+
+		FUpdatePhysicsBucketDrop Callback;
+		Callback.NativeCallback.BindUObject(InObject, InFunc);
+		Callback.FunctionName = FunctionName;
+		Callback.BoundObject = FObjectKey(InObject);
+		Callback.Priority = Priority;
+		return AddBucketEntry(UpdateHTZ, Callback);
+	}
+
+	// Registers a two phase entry, InGatherFunc must be thread safe and only read state as it runs across workers when the
+	// phase is large enough, InCommitFunc then runs on the game thread to act on it (send RPCs, set timers, etc)
+	// Actors, components and physics bodies are not safe to read from the gather, it should only work on data that the
+	// game thread snapshotted beforehand and that nothing else touches until the commit
+	template<typename classType>
+	FPhysicsBucketHandle AddReplicatingObject(uint32 UpdateHTZ, classType* InObject, bool(classType::* InCommitFunc)(), bool(classType::* InGatherFunc)(), FName FunctionName = NAME_None, float Priority = 1.0f)
+	{
+		if (!InObject || !InCommitFunc || !InGatherFunc || UpdateHTZ < 1)
+			return FPhysicsBucketHandle();
+
+		if (!FunctionName.IsNone())
+		{
+			RemoveBucketObject(InObject, FunctionName);
+		}
+
+		FUpdatePhysicsBucketDrop Callback;
+		Callback.NativeCallback.BindUObject(InObject, InCommitFunc);
+		Callback.GatherCallback.BindUObject(InObject, InGatherFunc);
+		Callback.FunctionName = FunctionName;
+		Callback.BoundObject = FObjectKey(InObject);
+		Callback.Priority = Priority;
+		return AddBucketEntry(UpdateHTZ, Callback);
+	}
+
+	// Registers a functor returning bool that is called directly, it stops firing once the owning object is gone
+	template<typename FunctorType>
+	FPhysicsBucketHandle AddReplicatingLambda(uint32 UpdateHTZ, UObject* InOwner, FunctorType&& InFunctor, FName FunctionName = NAME_None, float Priority = 1.0f)
+	{
+		if (!InOwner || UpdateHTZ < 1)
+			return FPhysicsBucketHandle();
+
+		if (!FunctionName.IsNone())
+		{
+			RemoveBucketObject(InOwner, FunctionName);
+		}
+
+		FUpdatePhysicsBucketDrop Callback;
+		Callback.NativeCallback.BindWeakLambda(InOwner, Forward<FunctorType>(InFunctor));
+		Callback.FunctionName = FunctionName;
+		Callback.BoundObject = FObjectKey(InOwner);
+		Callback.Priority = Priority;
+		return AddBucketEntry(UpdateHTZ, Callback);
+	}
+
+	// Registers a native member function to run once after the delay, the FTimerManager::SetTimer of the bucket container
+	// When FunctionName is set an existing entry with the same name is replaced, which re-arms the timer
+	template<typename classType>
+	FPhysicsBucketHandle AddOneShotTimer(float DelaySeconds, classType* InObject, void(classType::* InFunc)(), FName FunctionName = NAME_None, float Priority = 1.0f)
+	{
+		if (!InObject || !InFunc)
+			return FPhysicsBucketHandle();
+
+		if (!FunctionName.IsNone())
+		{
+			RemoveBucketObject(InObject, FunctionName);
+		}
+
+		FUpdatePhysicsBucketDrop Callback;
+		Callback.NativeCallback.BindWeakLambda(InObject, [InObject, InFunc]()
+		{
+			(InObject->*InFunc)();
+			return false;
+		});
+		Callback.FunctionName = FunctionName;
+		Callback.BoundObject = FObjectKey(InObject);
+		Callback.Priority = Priority;
+		return AddTimerEntry(DelaySeconds, Callback);
 	}
-	*/
 
 	bool RemoveBucketObject(UObject* ObjectToRemove, FName FunctionName);
 	bool RemoveBucketObject(FDynamicPhysicsBucketUpdateTickSignature& DynEvent);
 	bool RemoveObjectFromAllBuckets(UObject* ObjectToRemove);
 
+	// Removes every entry whose bound object no longer resolves, returns the number of entries removed
+	int32 PurgeDeadEntries();
+
 	bool IsObjectInBucket(UObject* ObjectToRemove);
 	bool IsObjectFunctionInBucket(UObject* ObjectToRemove, FName FunctionName);
 	bool IsObjectDelegateInBucket(FDynamicPhysicsBucketUpdateTickSignature& DynEvent);
 
+	// Fires the entry and removes it if it reports that it is complete or invalid
+	void ExecuteEntry(int32 EntryIndex);
+
+	// Runs the gather stage of every entry in the phase, across workers if there are enough of them, then commits serially
+	void ExecuteGatherCommit(const TArray<int32>& PhaseEntries);
+
 	FUpdatePhysicsBucketContainer()
 	{
 		bNeedsUpdate = false;
+		DispatchMode = EPhysicsBucketDispatchMode::Batched;
+		bIsDispatching = false;
+		bHasPendingDispatchMode = false;
+		PendingDispatchMode = EPhysicsBucketDispatchMode::Batched;
+		TickRate = 120.0f;
+		TickAccumulator = 0.0;
+		CurrentTick = 0;
+		NumTimers = 0;
+		MaxCallbacksPerFrame = 0;
+		FrameBudgetSeconds = 0.0;
+		SchedulerTime = 0.0;
+		NumRegisteredEntries = 0;
+		NumGatherEntries = 0;
 	};
+
+private:
+	// Resolves an entry index that may still be in the pending list
+	FUpdatePhysicsBucketDrop& GetEntry(int32 EntryIndex);
+	const FUpdatePhysicsBucketDrop& GetEntry(int32 EntryIndex) const;
+
+	int32 FindObjectFunctionEntry(UObject* InObject, FName FunctionName) const;
+	int32 FindDelegateEntry(FDynamicPhysicsBucketUpdateTickSignature& DynEvent) const;
+
+	void LinkEntry(int32 EntryIndex, uint32 PeriodTicks);
+
+	// Shared slot allocation of AddBucketEntry and AddTimerEntry, the entry is linked right away or once dispatch ends
+	FPhysicsBucketHandle RegisterEntry(const FUpdatePhysicsBucketDrop& Callback);
+
+	// Places a one shot entry in the wheel slot of its deadline, EarliestTick is the first tick that is still going to be processed
+	void LinkTimer(int32 EntryIndex, uint64 EarliestTick);
+
+	// Moves the wheel forward a tick at a time, cascading the upper levels down and firing the one shot entries that are due
+	void AdvanceTimers(int64 NumTicks);
+
+	// Unregisters the entry, the slot itself is released right away or at the end of the current dispatch
+	void RemoveEntry(int32 EntryIndex);
+
+	// Unlinks the entry from its phase and returns its slot to the free list
+	void ReleaseEntry(int32 EntryIndex);
+
+	// Applies every add and remove that was queued while the buckets were firing
+	void FlushPendingMutations();
+};
+
+// State of a single body from the per frame physics state gather
+struct FGatheredPhysicsState
+{
+	FRigidBodyState State;
+
+	// Frame of the Chaos replication cache the state came from, 0 when it was read from the game thread body instead
+	int32 CacheFrame = 0;
+
+	// Server physics frame that the state belongs to
+	int32 PhysicsFrame = INDEX_NONE;
+
+	// If the body moved past its thresholds since its state was last marked as sent, or was never sent
+	bool bChanged = true;
+};
+
+// Structure of arrays holding the physics state of every body registered for the bulk gather
+// Lanes are padded to a multiple of LaneWidth slots so change detection runs over 4 bodies per vector op
+struct REPLICATEDPHYSICS_API FPhysicsStateGatherBuffer
+{
+	enum ELane : int32
+	{
+		LocationX, LocationY, LocationZ,
+		RotationX, RotationY, RotationZ, RotationW,
+		LinearVelocityX, LinearVelocityY, LinearVelocityZ,
+		AngularVelocityX, AngularVelocityY, AngularVelocityZ,
+		NumLanes
+	};
+
+	enum EFlags : uint8
+	{
+		Registered = 1 << 0,
+		Valid = 1 << 1,
+		Sleeping = 1 << 2,
+		FromCache = 1 << 3,
+		HasSent = 1 << 4,
+		SentSleeping = 1 << 5,
+		Changed = 1 << 6,
+		Paused = 1 << 7
+	};
+
+	static constexpr int32 LaneWidth = 4;
+
+	// State read this frame and the state last marked as sent, which changes are measured against
+	TArray<double> Current[NumLanes];
+	TArray<double> Sent[NumLanes];
+
+	// Per slot thresholds, squared for the distances and the cosine of half the angle for the rotation
+	TArray<double> LocationThresholdSq;
+	TArray<double> VelocityThresholdSq;
+	TArray<double> RotationThresholdCos;
+
+	TArray<TWeakObjectPtr<UPrimitiveComponent>> Components;
+	TArray<int32> PhysicsFrames;
+	TArray<uint8> Flags;
+	TArray<int32> FreeSlots;
+
+	int32 NumSlots = 0;
+	int32 NumRegistered = 0;
+	int32 NumChanged = 0;
+	int32 CacheFrame = 0;
+	uint64 LastGatherFrame = MAX_uint64;
+
+	int32 AddSlot(UPrimitiveComponent* Component, float LocationThreshold, float RotationThreshold, float VelocityThreshold);
+	void RemoveSlot(int32 Slot);
+
+	// Reads the state of every registered body, from the Chaos replication cache when it has one
+	void Gather(UWorld* World);
+
+	// Flags every valid slot that moved past its thresholds from its sent state
+	void DetectChanges();
+
+	void MarkSent(int32 Slot);
+	void GetState(int32 Slot, FGatheredPhysicsState& OutState) const;
 };
 
 UCLASS()
@@ -102,10 +575,100 @@ public:
 	//UPROPERTY()
 	FUpdatePhysicsBucketContainer BucketContainer;
 
+	// Runs right after the buckets fire, from the same tick (so ahead of the NetDriver flush when aligned to the net tick)
+	FOnPhysicsBucketsDispatched OnBucketsDispatched;
+
 	// Adds an object to an update bucket with the set HTZ, calls the passed in UFUNCTION name
 	// If one of the bucket contains an entry with the function already then the existing one is removed and the new one is added
 	bool AddObjectToBucket(int32 UpdateHTZ, UObject* InObject, FName FunctionName);
 
+	// Same as AddObjectToBucket but returns a handle to the registration that can be removed or queried in constant time
+	// Priority weighs the entry against other overdue entries once the frame budget runs out
+	FPhysicsBucketHandle AddObjectToBucketWithHandle(int32 UpdateHTZ, UObject* InObject, FName FunctionName, float Priority = 1.0f);
+
+	// Adds a native member function to an update bucket with the set HTZ, it is called directly without UFunction reflection
+	// If FunctionName is set then it behaves like AddObjectToBucket, replacing any entry with the same name
+	template<typename classType>
+	FPhysicsBucketHandle AddReplicatingObject(int32 UpdateHTZ, classType* InObject, bool(classType::* InFunc)(), FName FunctionName = NAME_None, float Priority = 1.0f)
+	{
+		if (!InObject || UpdateHTZ < 1)
+			return FPhysicsBucketHandle();
+
+		return BucketContainer.AddReplicatingObject(UpdateHTZ, InObject, InFunc, FunctionName, Priority);
+	}
+
+	// Adds a two phase entry, the gather function has to be thread safe as it can run across workers
+	// Bodies registered in the physics state gather are snapshotted before these fire, read them with PeekGatheredPhysicsState
+	template<typename classType>
+	FPhysicsBucketHandle AddReplicatingObject(int32 UpdateHTZ, classType* InObject, bool(classType::* InCommitFunc)(), bool(classType::* InGatherFunc)(), FName FunctionName = NAME_None, float Priority = 1.0f)
+	{
+		if (!InObject || UpdateHTZ < 1)
+			return FPhysicsBucketHandle();
+
+		return BucketContainer.AddReplicatingObject(UpdateHTZ, InObject, InCommitFunc, InGatherFunc, FunctionName, Priority);
+	}
+
+	// Runs the member function once after the delay, a cheaper alternative to FTimerManager for short per object timeouts
+	// The handle can be cancelled with RemoveBucketEntry, when FunctionName is set a pending timer with the same name is re-armed
+	template<typename classType>
+	FPhysicsBucketHandle AddOneShotTimer(float DelaySeconds, classType* InObject, void(classType::* InFunc)(), FName FunctionName = NAME_None)
+	{
+		if (!InObject)
+			return FPhysicsBucketHandle();
+
+		return BucketContainer.AddOneShotTimer(DelaySeconds, InObject, InFunc, FunctionName);
+	}
+
+	// Runs the member function once right before the next physics step of the world, from the game thread
+	// Queuing an object that is already queued is a no-op, so this is meant for one apply function per object
+	// Used to push state that arrived over several packets into physics in a single pass
+	template<typename classType>
+	void QueuePrePhysicsApply(classType* InObject, void(classType::* InFunc)())
+	{
+		if (!InObject)
+			return;
+
+		const FObjectKey ObjectKey(InObject);
+		if (!PendingPrePhysicsApplies.Contains(ObjectKey))
+		{
+			PendingPrePhysicsApplies.Add(ObjectKey, FSimpleDelegate::CreateUObject(InObject, InFunc));
+		}
+	}
+
+	// Registers the component in the bulk gather that reads the physics state of every registered body once per frame
+	// Thresholds are the location (cm), rotation (deg) and velocity (cm/s and deg/s) changes that count as a change
+	// Returns the slot of the component, or INDEX_NONE if it couldn't be registered
+	int32 RegisterPhysicsStateGather(UPrimitiveComponent* Component, float LocationThreshold, float RotationThreshold, float VelocityThreshold);
+	void UnregisterPhysicsStateGather(int32& Slot);
+
+	// Returns the state gathered for the slot this frame, the first request of a frame gathers every registered body
+	// Returns false if the slot doesn't belong to the component or its body isn't simulating
+	bool GetGatheredPhysicsState(int32 Slot, const UPrimitiveComponent* Component, FGatheredPhysicsState& OutState);
+
+	// Reads the slot from this frame's gather without gathering or resolving the component, safe from bucket gather stages
+	// Every registered body is gathered before two phase entries fire, returns false if that didn't happen this frame
+	// or the body isn't simulating
+	bool PeekGatheredPhysicsState(int32 Slot, FGatheredPhysicsState& OutState) const;
+
+	// Makes the slot's state of this frame the one that later changes are measured against
+	void MarkGatheredPhysicsStateSent(int32 Slot);
+
+	// Paused slots are skipped by the gather, for bodies whose actor doesn't replicate at the moment (dormant, etc)
+	// Changes are still measured against the last sent state once the slot resumes
+	void SetPhysicsStateGatherPaused(int32 Slot, bool bPaused);
+
+	// Removes the registration that the handle points to, the handle is invalidated
+	bool RemoveBucketEntry(FPhysicsBucketHandle& Handle);
+
+	// Returns if the handle still points to a registration, entries that reported completion are no longer registered
+	bool IsBucketEntryRegistered(const FPhysicsBucketHandle& Handle) const;
+
+	// Changes the priority that the entry is scheduled with when the frame budget runs out
+	bool SetBucketEntryPriority(const FPhysicsBucketHandle& Handle, float NewPriority);
+
+	// Returns how late the entry last fired in seconds, always 0 while no frame budget is set
+	float GetBucketEntryLateness(const FPhysicsBucketHandle& Handle) const;
+
 	// Adds an object to an update bucket with the set HTZ, calls the passed in UFUNCTION name
 	// If one of the bucket contains an entry with the function already then the existing one is removed and the new one is added
 	UFUNCTION(BlueprintCallable, meta = (DisplayName = "Add Object to Bucket Updates", ScriptName = "AddObjectToBucket"), Category = "BucketUpdateSubsystem")
@@ -134,6 +697,45 @@ public:
 	UFUNCTION(BlueprintPure, Category = "BucketUpdateSubsystem")
 	bool IsActive();
 
+	// Sets if buckets fire all of their entries at once or spread them across the frames of their period
+	UFUNCTION(BlueprintCallable, Category = "BucketUpdateSubsystem")
+	void SetDispatchMode(EPhysicsBucketDispatchMode NewDispatchMode);
+
+	UFUNCTION(BlueprintPure, Category = "BucketUpdateSubsystem")
+	EPhysicsBucketDispatchMode GetDispatchMode() const;
+
+	// Limits how much work a single bucket update does, 0 for both fires every entry as soon as it is due
+	// Once the budget runs out the remaining due entries are carried over, the latest and highest priority ones fire first
+	UFUNCTION(BlueprintCallable, Category = "BucketUpdateSubsystem")
+	void SetFrameBudget(float BudgetMs = 0.0f, int32 MaxCallbacks = 0);
+
+	// Counters of the last bucket update, also published to STATGROUP_ReplicatedPhysics and the ReplicatedPhysics CSV category
+	const FPhysicsBucketFrameStats& GetLastFrameStats() const
+	{
+		return BucketContainer.LastFrameStats;
+	}
+
+	int32 GetNumRegisteredEntries() const
+	{
+		return BucketContainer.NumRegisteredEntries;
+	}
+
+	// Fires the buckets from the world's post actor tick instead of the tickable object tick
+	// UWorld::Tick always runs that ahead of the NetDriver's tick flush, so callback RPCs leave in that frame's packet
+	// Falls back to the tickable object tick while the world has no NetDriver
+	UFUNCTION(BlueprintCallable, Category = "BucketUpdateSubsystem")
+	void SetAlignToNetTick(bool bNewAlignToNetTick);
+
+	UFUNCTION(BlueprintPure, Category = "BucketUpdateSubsystem")
+	bool IsAlignedToNetTick() const;
+
+	// Drops the entries of objects that were garbage collected without being removed, runs after every GC
+	int32 PurgeDeadEntries();
+
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+
 	// FTickableGameObject functions
 	/**
 	 * Function called every frame on this GripScript. Override this function to implement custom logic to be executed every frame.
@@ -151,4 +753,28 @@ public:
 	virtual TStatId GetStatId() const override;
 
 	// End tickable object information
+
+private:
+	void BindNetTick();
+	void UnbindNetTick();
+	void OnWorldPostActorTick(UWorld* InWorld, ELevelTick TickType, float DeltaSeconds);
+	void OnPostGarbageCollect();
+	void OnPhysScenePreTick(FPhysScene_Chaos* PhysScene, float DeltaSeconds);
+	void FlushPrePhysicsApplies();
+	void GatherPhysicsStatesIfNeeded();
+
+	// Fires the buckets, gathering the physics states first when a two phase entry may read them
+	void DispatchBuckets(float DeltaTime);
+
+	bool bAlignToNetTick = false;
+	FDelegateHandle NetTickHandle;
+	FDelegateHandle PostGarbageCollectHandle;
+	FDelegateHandle PhysScenePreTickHandle;
+
+	// Flushed from the physics scene's pre tick, or from our own tick while the world has no physics scene
+	// The flush swaps the two so that applies queued while it runs land in the next step
+	TMap<FObjectKey, FSimpleDelegate> PendingPrePhysicsApplies;
+	TMap<FObjectKey, FSimpleDelegate> FlushingPrePhysicsApplies;
+
+	FPhysicsStateGatherBuffer PhysicsStateGather;
 };
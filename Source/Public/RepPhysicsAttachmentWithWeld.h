@@ -14,6 +14,8 @@ struct REPLICATEDPHYSICS_API FRepPhysicsAttachmentWithWeld : public FRepAttachme
 	UPROPERTY()
 	bool bIsWelded;
 
+	// Only the fields that differ from their defaults are written, behind a mask
+	// The usual attachment (no socket, unit scale, on the parent's root) comes down to the parent and the offsets
 	bool NetSerialize(FArchive& Ar, class UPackageMap* Map, bool& bOutSuccess);
 
 	FRepPhysicsAttachmentWithWeld();
@@ -24,7 +26,8 @@ struct TStructOpsTypeTraits<FRepPhysicsAttachmentWithWeld> : public TStructOpsTy
 {
 	enum
 	{
-		WithNetSerializer = true /*,
-		WithNetSharedSerialization = true,*/
+		WithNetSerializer = true
+		// No WithNetSharedSerialization, shared serialization runs without a package map
+		// and AttachParent / AttachComponent need the connection's to be written
 	};
 };
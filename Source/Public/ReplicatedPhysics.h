@@ -2,8 +2,24 @@
 
 #pragma once
 
+#include "PhysicsBucketUpdateSubsystem.h"
+
 #include "ReplicatedPhysics.generated.h"
 
+// Bits per component of the smallest three rotation encoding, the largest component is rebuilt from the other three
+UENUM(BlueprintType)
+enum class ERepPhysicsRotationPrecision : uint8
+{
+	// 9 bits per component, 29 bits per rotation, roughly 0.3 degrees
+	Low,
+
+	// 11 bits per component, 35 bits per rotation, roughly 0.08 degrees
+	Medium,
+
+	// 15 bits per component, 47 bits per rotation, roughly 0.005 degrees
+	High
+};
+
 USTRUCT()
 struct REPLICATEDPHYSICS_API FRepMovementPhysics : public FRepMovement
 {
@@ -13,8 +29,20 @@ public:
 	FRepMovementPhysics();
 	FRepMovementPhysics(FRepMovement& Other);
 	void CopyTo(FRepMovement& Other) const;
+
+	// Smallest three rotation, velocities quantized to 16 bits within power of two bounds, the angular velocity is skipped
+	// without bRepPhysics. The encoding settings travel in a 12 bit header so the receiving end needs no setup
 	bool NetSerialize(FArchive& Ar, UPackageMap* Map, bool& bOutSuccess);
 	bool GatherActorsMovement(AActor* OwningActor);
+
+	// Sets the bounds (cm/s and deg/s) that velocities are clamped to and the rotation precision, tighter bounds mean finer steps
+	void SetEncodingSettings(float MaxLinearSpeed, float MaxAngularSpeed, ERepPhysicsRotationPrecision InRotationPrecision);
+
+	ERepPhysicsRotationPrecision RotationPrecision = ERepPhysicsRotationPrecision::Medium;
+
+	// Velocities are bounded by 2^Exponent, 8192 cm/s and 2048 deg/s by default
+	uint8 LinearVelocityRangeExponent = 13;
+	uint8 AngularVelocityRangeExponent = 11;
 };
 
 template <>
@@ -27,6 +55,99 @@ struct TStructOpsTypeTraits<FRepMovementPhysics> : public TStructOpsTypeTraitsBa
 	};
 };
 
+// Movement snapped to the fixed grid that client auth deltas are taken on
+// Both ends rebuild the exact same values from it, so deltas against it never drift
+struct REPLICATEDPHYSICS_API FQuantizedPhysicsState
+{
+	// Same grid as FRepMovementPhysics, location in 1/100th units (RoundTwoDecimals), rotation as the smallest three
+	// quaternion components and velocities as steps of their bounded range, offset so that a resting axis is zero
+	FIntVector Location = FIntVector::ZeroValue;
+	FIntVector Rotation = FIntVector::ZeroValue;
+	FIntVector LinearVelocity = FIntVector::ZeroValue;
+	FIntVector AngularVelocity = FIntVector::ZeroValue;
+	uint8 RotationLargestIndex = 0;
+	bool bSimulatedPhysicSleep = false;
+	bool bRepPhysics = false;
+
+	// Encoding settings of the movement, only sent with full states, deltas use the ones of their baseline
+	ERepPhysicsRotationPrecision RotationPrecision = ERepPhysicsRotationPrecision::Medium;
+	uint8 LinearVelocityRangeExponent = 13;
+	uint8 AngularVelocityRangeExponent = 11;
+
+	// Quantizes with the encoding settings of the movement
+	void FromMovement(const FRepMovementPhysics& Movement);
+	void ToMovement(FRepMovementPhysics& OutMovement) const;
+
+	// Deltas are only meaningful between states on the same grid
+	bool HasSameEncoding(const FQuantizedPhysicsState& Other) const;
+
+	// Component wise difference against the baseline, the largest rotation index and the flags are sent as is
+	FQuantizedPhysicsState GetDeltaFrom(const FQuantizedPhysicsState& Baseline) const;
+	FQuantizedPhysicsState AddDelta(const FQuantizedPhysicsState& Delta) const;
+};
+
+// Ring of recent states keyed by sequence, the client keeps what it sent and the server what it received
+struct REPLICATEDPHYSICS_API FClientAuthStateHistory
+{
+	static constexpr int32 Capacity = 32;
+
+	void Reset();
+	void Store(uint16 Sequence, const FQuantizedPhysicsState& State);
+	const FQuantizedPhysicsState* Find(uint16 Sequence) const;
+
+private:
+	FQuantizedPhysicsState States[Capacity];
+	uint16 Sequences[Capacity] = {};
+	bool bIsValid[Capacity] = {};
+};
+
+// Client auth movement update, either a full state or a delta against a state the server has acknowledged
+USTRUCT()
+struct REPLICATEDPHYSICS_API FRepClientAuthMovement
+{
+	GENERATED_BODY()
+
+public:
+	uint16 Sequence = 0;
+	uint16 BaselineSequence = 0;
+	bool bIsFullState = true;
+
+	// The absolute state for a full update, the difference against the baseline otherwise
+	FQuantizedPhysicsState State;
+
+	bool NetSerialize(FArchive& Ar, UPackageMap* Map, bool& bOutSuccess);
+};
+
+template <>
+struct TStructOpsTypeTraits<FRepClientAuthMovement> : public TStructOpsTypeTraitsBase2<FRepClientAuthMovement>
+{
+	enum
+	{
+		WithNetSerializer = true,
+	};
+};
+
+// Server side end of a client auth session, replicated to the owner so that it knows when server movement can be trusted again
+USTRUCT()
+struct REPLICATEDPHYSICS_API FClientAuthHandbackState
+{
+	GENERATED_BODY()
+
+public:
+	// Server physics frame at which the server took authority back
+	UPROPERTY()
+	int32 HandbackFrame = INDEX_NONE;
+
+	// Newest client auth update the server had received by then, tells the owner which session the handback belongs to
+	// Cleared along with the server's receive state when the owning connection changes
+	UPROPERTY()
+	uint16 HandbackSequence = 0;
+
+	// Server physics frame that the replicated movement was gathered at, only kept up to date while a handback settles
+	UPROPERTY()
+	int32 MovementFrame = INDEX_NONE;
+};
+
 USTRUCT(BlueprintType)
 struct REPLICATEDPHYSICS_API FPhysicsClientAuthReplicationData
 {
@@ -37,8 +158,128 @@ public:
 	UPROPERTY(EditAnywhere, NotReplicated, BlueprintReadOnly, Category="Networking", meta=(ClampMin="0", ClampMax="100"))
 	int32 UpdateRate = 30;
 
-	FTimerHandle ResetReplicationHandle;
+	// Weight of the poll against other overdue bucket entries when the bucket subsystem runs out of frame budget
+	UPROPERTY(EditAnywhere, NotReplicated, BlueprintReadOnly, Category="Networking", meta=(ClampMin="0"))
+	float UpdatePriority = 1.f;
+
+	// Moves the session between bucket rates while it runs instead of always using UpdateRate
+	// The rate follows linear and angular speed, recent contacts (requires hit events) and the distance to other players
+	UPROPERTY(EditAnywhere, NotReplicated, BlueprintReadOnly, Category="Networking|AdaptiveRate")
+	bool bUseAdaptiveUpdateRate = false;
+
+	UPROPERTY(EditAnywhere, NotReplicated, BlueprintReadOnly, Category="Networking|AdaptiveRate", meta=(EditCondition="bUseAdaptiveUpdateRate", ClampMin="1", ClampMax="100"))
+	int32 MinAdaptiveUpdateRate = 10;
+
+	UPROPERTY(EditAnywhere, NotReplicated, BlueprintReadOnly, Category="Networking|AdaptiveRate", meta=(EditCondition="bUseAdaptiveUpdateRate", ClampMin="1", ClampMax="100"))
+	int32 MaxAdaptiveUpdateRate = 60;
+
+	// Linear speed (cm/s) at and above which the max rate is used
+	UPROPERTY(EditAnywhere, NotReplicated, BlueprintReadOnly, Category="Networking|AdaptiveRate", meta=(EditCondition="bUseAdaptiveUpdateRate", ClampMin="1"))
+	float AdaptiveMaxRateLinearSpeed = 1500.f;
+
+	// Angular speed (deg/s) at and above which the max rate is used
+	UPROPERTY(EditAnywhere, NotReplicated, BlueprintReadOnly, Category="Networking|AdaptiveRate", meta=(EditCondition="bUseAdaptiveUpdateRate", ClampMin="1"))
+	float AdaptiveMaxRateAngularSpeed = 720.f;
+
+	// How long after a contact the max rate is used
+	UPROPERTY(EditAnywhere, NotReplicated, BlueprintReadOnly, Category="Networking|AdaptiveRate", meta=(EditCondition="bUseAdaptiveUpdateRate", ClampMin="0"))
+	float AdaptiveContactBoostTime = 0.25f;
+
+	// Other players closer than the near distance get the max rate, past the far distance they no longer raise it
+	UPROPERTY(EditAnywhere, NotReplicated, BlueprintReadOnly, Category="Networking|AdaptiveRate", meta=(EditCondition="bUseAdaptiveUpdateRate", ClampMin="0"))
+	float AdaptiveNearPlayerDistance = 500.f;
+
+	UPROPERTY(EditAnywhere, NotReplicated, BlueprintReadOnly, Category="Networking|AdaptiveRate", meta=(EditCondition="bUseAdaptiveUpdateRate", ClampMin="0"))
+	float AdaptiveFarPlayerDistance = 3000.f;
+
+	// Rates are snapped up to a multiple of this so that sessions share buckets
+	UPROPERTY(EditAnywhere, NotReplicated, BlueprintReadOnly, Category="Networking|AdaptiveRate", meta=(EditCondition="bUseAdaptiveUpdateRate", ClampMin="1"))
+	int32 AdaptiveRateStep = 10;
+
+	// Raising the rate is immediate, lowering only happens once the wanted rate drops this fraction below the current one
+	UPROPERTY(EditAnywhere, NotReplicated, BlueprintReadOnly, Category="Networking|AdaptiveRate", meta=(EditCondition="bUseAdaptiveUpdateRate", ClampMin="0", ClampMax="1"))
+	float AdaptiveRateHysteresis = 0.25f;
+
+	// The rate the current session is polling at
+	int32 CurrentUpdateRate = 0;
+	float LastContactTime = -1.f;
+
+	// Sends movement as deltas against the last state the server acknowledged, falling back to a full state
+	// at the start of a session or when the acknowledged state is too old (lost packets)
+	UPROPERTY(EditAnywhere, NotReplicated, BlueprintReadOnly, Category="Networking")
+	bool bUseDeltaCompression = true;
+
+	// Number of sends that the acknowledged baseline can trail by before a full state is sent instead
+	UPROPERTY(EditAnywhere, NotReplicated, BlueprintReadOnly, Category="Networking", meta=(EditCondition="bUseDeltaCompression", ClampMin="1", ClampMax="31"))
+	int32 MaxDeltaBaselineAge = 16;
+
+	// Only sends when the state drifts away from what the server extrapolates from the last send (ballistic under gravity,
+	// constant angular velocity), or when the keep alive is due. The last state before coming to rest is always sent
+	UPROPERTY(EditAnywhere, NotReplicated, BlueprintReadOnly, Category="Networking|ErrorGate")
+	bool bUseErrorGatedSending = false;
+
+	// Location error (cm) past which the state is sent
+	UPROPERTY(EditAnywhere, NotReplicated, BlueprintReadOnly, Category="Networking|ErrorGate", meta=(EditCondition="bUseErrorGatedSending", ClampMin="0"))
+	float ErrorGateLocationThreshold = 5.f;
+
+	// Rotation error (degrees) past which the state is sent
+	UPROPERTY(EditAnywhere, NotReplicated, BlueprintReadOnly, Category="Networking|ErrorGate", meta=(EditCondition="bUseErrorGatedSending", ClampMin="0"))
+	float ErrorGateRotationThreshold = 5.f;
+
+	// Linear velocity error (cm/s) past which the state is sent
+	UPROPERTY(EditAnywhere, NotReplicated, BlueprintReadOnly, Category="Networking|ErrorGate", meta=(EditCondition="bUseErrorGatedSending", ClampMin="0"))
+	float ErrorGateVelocityThreshold = 50.f;
+
+	// Minimum rate (Hz) that the state is sent at regardless of the error
+	UPROPERTY(EditAnywhere, NotReplicated, BlueprintReadOnly, Category="Networking|ErrorGate", meta=(EditCondition="bUseErrorGatedSending", ClampMin="0.1"))
+	float ErrorGateKeepAliveRate = 4.f;
+
+	// What the server last received and when, the base of the extrapolation
+	FRepMovementPhysics LastSentMovement;
+	float LastSentTime = 0.f;
+	bool bHasSentMovement = false;
+
+	// Encoding of the full movement RPC (the path without delta compression or batching)
+	UPROPERTY(EditAnywhere, NotReplicated, BlueprintReadOnly, Category="Networking|Encoding")
+	ERepPhysicsRotationPrecision MovementRotationPrecision = ERepPhysicsRotationPrecision::Medium;
+
+	// Linear speed (cm/s) that the sent velocity is clamped to, rounded up to a power of two
+	UPROPERTY(EditAnywhere, NotReplicated, BlueprintReadOnly, Category="Networking|Encoding", meta=(ClampMin="1"))
+	float MaxReplicatedLinearSpeed = 5000.f;
+
+	// Angular speed (deg/s) that the sent angular velocity is clamped to, rounded up to a power of two
+	UPROPERTY(EditAnywhere, NotReplicated, BlueprintReadOnly, Category="Networking|Encoding", meta=(ClampMin="1"))
+	float MaxReplicatedAngularSpeed = 1440.f;
+
+	// Sequence of the next send and the first one of the current session, acks from before it are ignored
+	uint16 NextSendSequence = 1;
+	uint16 SessionFirstSequence = 1;
+	FClientAuthStateHistory SentStates;
+
+	// Keeps taking server movement during a session instead of ignoring it, through Chaos resimulation the owner keeps its
+	// own prediction and only rewinds and resimulates from the server's frame when they diverge past the project's
+	// resimulation thresholds. Needs physics prediction enabled in the project's physics settings, blocks as usual without it
+	UPROPERTY(EditAnywhere, NotReplicated, BlueprintReadOnly, Category="Networking|Resimulation")
+	bool bUseResimulation = false;
+
+	// Once a session ends the owner ignores server movement until it replicates movement from at or after the server's
+	// handback frame, this releases the block anyway if that never arrives (the server got none of the session's updates)
+	UPROPERTY(EditAnywhere, NotReplicated, BlueprintReadOnly, Category="Networking", meta=(ClampMin="0"))
+	float HandbackTimeout = 1.f;
+
+	bool bIsAwaitingHandback = false;
+
+	// Pending one shot in the bucket subsystem that releases the replication block after HandbackTimeout
+	FPhysicsBucketHandle ResetReplicationHandle;
+	FPhysicsBucketHandle PollBucketHandle;
 	FTransform LastActorTransform = FTransform::Identity;
 	float TimeAtInitialThrow = 0.f;
 	bool bIsCurrentlyClientAuth = false;
+
+	// Sampled by the poll's gather stage, possibly on a worker, and consumed by the poll on the game thread
+	FRepMovementPhysics GatheredMovement;
+	FTransform GatheredTransform = FTransform::Identity;
+	bool bGatheredTransformChanged = false;
+	bool bGatheredMovementValid = false;
+	bool bGatheredRigidBodyAwake = false;
 };
@@ -7,6 +7,9 @@
 
 #include "ReplicatedPhysicsActor.generated.h"
 
+class UNetConnection;
+class UReplicatedPhysicsClientAuthComponent;
+
 UCLASS()
 class REPLICATEDPHYSICS_API AReplicatedPhysicsActor : public AActor
 {
@@ -24,7 +27,10 @@ public:
 	virtual void OnRep_ReplicateMovement() override;
 	virtual void OnRep_ReplicatedMovement() override;
 	virtual void PostNetReceivePhysicState() override;
+	virtual void BeginPlay() override;
+	virtual void NotifyHit(UPrimitiveComponent* MyComp, AActor* Other, UPrimitiveComponent* OtherComp, bool bSelfMoved, FVector HitLocation, FVector HitNormal, FVector NormalImpulse, const FHitResult& Hit) override;
 	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+	virtual void SetOwner(AActor* NewOwner) override;
 	//~End AActor
 
 public:
@@ -40,21 +46,95 @@ public:
 	UFUNCTION(Category="Networking")
 	void CeaseReplicationBlocking();
 
+	// Releases the replication block once the server's movement has caught up with its handback, returns if it did
+	bool TryCompleteClientAuthHandback();
+
+	UFUNCTION()
+	void OnRep_ClientAuthHandback();
+
 	// Notify the server that we are no longer trying to run the throwing auth
 	UFUNCTION(Reliable, Server, WithValidation, Category="Networking")
 	void Server_EndClientAuthReplication();
 
+	// Sequence orders the unreliable updates so that the server can drop the ones that arrive late
+	UFUNCTION(Unreliable, Server, WithValidation, Category="Networking")
+	void Server_GetClientAuthReplication(const FRepMovementPhysics& NewMovement, uint16 Sequence);
+
+	// Compact variant of Server_GetClientAuthReplication used with delta compression
 	UFUNCTION(Unreliable, Server, WithValidation, Category="Networking")
-	void Server_GetClientAuthReplication(const FRepMovementPhysics& NewMovement);
+	void Server_GetClientAuthMovementUpdate(const FRepClientAuthMovement& MovementUpdate);
+
+	// Quantizes the movement and encodes it against the last acknowledged state if there is a usable one
+	void BuildClientAuthMovementUpdate(const FRepMovementPhysics& NewMovement, FRepClientAuthMovement& OutMovementUpdate);
+
+	// Sends the movement or session end through the owning player's batching component, or this actor's own RPCs without one
+	void SendClientAuthMovement(const FRepMovementPhysics& NewMovement);
+	void SendEndClientAuthReplication();
+
+	// Server side handling of the client auth RPCs, shared by the per actor and the batched path
+	// Updates older than the newest received one are dropped, the rest are queued for the next physics step
+	void ApplyClientAuthMovement(const FRepMovementPhysics& NewMovement, uint16 Sequence);
+
+	// Rebuilds the movement from its baseline, acknowledges it and queues it
+	void ApplyClientAuthMovementUpdate(const FRepClientAuthMovement& MovementUpdate);
+	void EndClientAuthReplication();
+
+	// Pushes the newest queued client auth movement into the physics replication target, run once per physics step
+	void ApplyPendingClientAuthMovement();
 
 	bool ShouldSkipAttachmentReplication() const
 	{
 		return false;
 	}
 
+	// Returns if client auth sessions are corrected through resimulation rather than blocking server movement
+	bool IsUsingResimulation() const;
+
+	// Returns if replicated movement is currently ignored in favour of our own client auth simulation
+	bool IsBlockingServerMovement() const;
+
+	// Gather stage of the poll, samples the transform and movement into ClientAuthReplicationData
+	// Only reads the root body's slot in the bucket subsystem's per frame gather and our own data, so it can run on a worker
+	bool GatherClientAuthState();
+
+	// Registers the poll in the bucket for the passed in rate, replacing any existing registration
+	void RegisterClientAuthPoll(int32 NewUpdateRate);
+
+	// Returns if the gathered movement has drifted far enough from the server's extrapolation of the last send to be sent
+	bool ShouldSendClientAuthMovement(const FRepMovementPhysics& NewMovement) const;
+
+	// Returns the rate that the adaptive mode wants the current session to poll at
+	int32 GetAdaptiveUpdateRate() const;
+
+	// Moves the session to a new bucket if the adaptive rate moved past the hysteresis
+	void UpdateAdaptiveUpdateRate();
+
 	// Getter to make sure ClientAuthReplicationData is dirtied
 	FPhysicsClientAuthReplicationData GetClientAuthReplicationData(FPhysicsClientAuthReplicationData& ClientAuthData);
 
+	// Returns if the gathered movement moved past the change thresholds from the last one that was dirtied
+	bool HasMovementChangedSinceLastDirty(const FRepMovement& Movement) const;
+
+	// Returns if the gathered attachment differs from the last one that was dirtied
+	bool HasAttachmentChangedSinceLastDirty() const;
+
+	// Puts the actor to DORM_DormantAll if its body is still asleep and its rest state was the last movement sent
+	void TryEnterSleepDormancy();
+
+	// Brings the actor back from sleep dormancy, a no-op unless it was put there by TryEnterSleepDormancy
+	void WakeFromSleepDormancy();
+
+	UFUNCTION()
+	void OnRootComponentWake(UPrimitiveComponent* WakingComponent, FName BoneName);
+
+	// Only bound while sleep dormant, any transform update (teleport, attachment change) wakes the actor
+	void OnRootTransformUpdated(USceneComponent* UpdatedComponent, EUpdateTransformFlags UpdateTransformFlags, ETeleportType Teleport);
+
+	bool IsSleepDormant() const
+	{
+		return bIsSleepDormant;
+	}
+
 public:
 	UPROPERTY(Replicated, ReplicatedUsing=OnRep_AttachmentReplication)
 	FRepPhysicsAttachmentWithWeld AttachmentWeldReplication;
@@ -65,4 +145,79 @@ protected:
 
 	UPROPERTY(EditAnywhere, Replicated, BlueprintReadWrite, Category="Replication")
 	bool bAllowIgnoringAttachOnOwner;
+
+	// Newest client auth update the server has received, the owner encodes its deltas against it
+	UPROPERTY(Replicated)
+	uint16 ClientAuthAckSequence = 0;
+
+	// Server physics frames of the last session handback and of the replicated movement, owner only
+	UPROPERTY(ReplicatedUsing=OnRep_ClientAuthHandback)
+	FClientAuthHandbackState ClientAuthHandback;
+
+	// Smallest location change in cm that dirties the replicated movement and attachment offset
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category="Replication|ChangeDetection", meta=(ClampMin="0"))
+	float MovementLocationThreshold = 0.1f;
+
+	// Smallest change in degrees on any rotation axis that dirties the replicated movement and attachment offset
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category="Replication|ChangeDetection", meta=(ClampMin="0"))
+	float MovementRotationThreshold = 0.1f;
+
+	// Smallest linear (cm/s) or angular (deg/s) velocity change that dirties the replicated movement
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category="Replication|ChangeDetection", meta=(ClampMin="0"))
+	float MovementVelocityThreshold = 1.f;
+
+	// Server side, once the body sleeps and its rest state is sent the actor goes DORM_DormantAll until physics wakes it
+	// Contacts, transform and attachment changes, owner changes and client auth updates also wake it
+	// Actors owned by a connection stay awake unless the owner batches client auth through UReplicatedPhysicsClientAuthComponent
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category="Replication|Dormancy")
+	bool bUseSleepDormancy = true;
+
+	// Seconds the body has to stay asleep after its rest state is sent, the engine then still waits for it to be acked
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category="Replication|Dormancy", meta=(EditCondition="bUseSleepDormancy", ClampMin="0"))
+	float SleepDormancyDelay = 1.f;
+
+private:
+	// Server side baselines of the current client auth session
+	FClientAuthStateHistory ReceivedClientAuthStates;
+
+	// Returns false for updates that are not newer than the newest one received, otherwise records the sequence
+	bool AcceptClientAuthSequence(uint16 Sequence);
+
+	// Forgets the sequence, baselines, ack and handback of the previous owning connection, its successor starts counting from 1 again
+	void ResetClientAuthReceiveState();
+
+	// Replaces whatever is queued, only the newest movement of a physics step gets applied
+	void QueueClientAuthMovement(const FRepMovementPhysics& NewMovement);
+
+	// Server side inbound state, the sequence is kept across the sessions of one owning connection and reset when it changes
+	FRepMovementPhysics PendingClientAuthMovement;
+	TWeakObjectPtr<UNetConnection> ClientAuthSequenceConnection;
+	uint16 NewestClientAuthSequence = 0;
+	bool bHasReceivedClientAuthSequence = false;
+	bool bHasPendingClientAuthMovement = false;
+
+	// Server side, the movement frame is only replicated until this time after a handback
+	float ClientAuthHandbackWindowEndTime = -1.f;
+
+	// Shadows of what was last dirtied for replication, gathered states within the thresholds are reverted to them
+	FRepMovement LastDirtiedMovement;
+	FRepPhysicsAttachmentWithWeld LastDirtiedAttachment;
+	bool bHasDirtiedMovement = false;
+	bool bHasDirtiedAttachment = false;
+
+	// Slot of the root body in the bucket subsystem's per frame physics state gather
+	// Registered at begin play on the server, and on the owning client for as long as a client auth session lasts
+	int32 PhysicsStateGatherSlot = INDEX_NONE;
+
+	// Resolved on the game thread when the session starts, the poll's gather stage can't look it up from a worker
+	UPROPERTY(Transient)
+	TObjectPtr<UPhysicsBucketUpdateSubsystem> ClientAuthGatherSubsystem = nullptr;
+
+	// Server side sleep dormancy, the handle is the pending TryEnterSleepDormancy
+	FPhysicsBucketHandle SleepDormancyHandle;
+	FDelegateHandle RootTransformUpdatedHandle;
+	bool bIsSleepDormant = false;
+
+	// Resolved when the session starts so that the poll doesn't walk the owner chain every fire
+	TWeakObjectPtr<UReplicatedPhysicsClientAuthComponent> ClientAuthBatcher;
 };
@@ -0,0 +1,85 @@
+﻿// Copyright Hitbox Games, LLC. All Rights Reserved.
+
+#pragma once
+
+#include "Components/ActorComponent.h"
+#include "ReplicatedPhysics.h"
+
+#include "ReplicatedPhysicsClientAuthComponent.generated.h"
+
+class AReplicatedPhysicsActor;
+
+USTRUCT()
+struct REPLICATEDPHYSICS_API FRepClientAuthBatchEntry
+{
+	GENERATED_BODY()
+
+public:
+	UPROPERTY()
+	TObjectPtr<AReplicatedPhysicsActor> Actor = nullptr;
+
+	UPROPERTY()
+	FRepClientAuthMovement Movement;
+};
+
+// Batches the client auth traffic of every replicated physics actor that a player owns
+// Add it to the PlayerController on the server, owned actors then send their movement and session ends through it
+// as one RPC per bucket fire instead of one per actor. Actors fall back to their own RPCs when it is missing
+UCLASS(ClassGroup=(Networking), meta=(BlueprintSpawnableComponent))
+class REPLICATEDPHYSICS_API UReplicatedPhysicsClientAuthComponent : public UActorComponent
+{
+	GENERATED_BODY()
+
+public:
+	UReplicatedPhysicsClientAuthComponent();
+
+	//~Begin UActorComponent
+	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+	//~End UActorComponent
+
+	// Returns the batching component of the PlayerController that owns the actor, if it has one and batching is on
+	static UReplicatedPhysicsClientAuthComponent* FindForActor(const AActor* InActor);
+
+	// Same lookup without requiring the local bucket binding, so the server can tell how the owner will reach the actor
+	static UReplicatedPhysicsClientAuthComponent* FindOwningComponent(const AActor* InActor);
+
+	// Queues the movement for the next flush, a newer movement for the same actor replaces the queued one
+	// Updates are encoded against the acknowledged baseline rather than each other, so dropping the older one is safe
+	void QueueMovement(AReplicatedPhysicsActor* InActor, const FRepClientAuthMovement& NewMovement);
+
+	// Queues the end of the actor's client auth session, sent reliably with the next flush
+	void QueueEndClientAuth(AReplicatedPhysicsActor* InActor);
+
+	// Sends everything that was queued, runs after every bucket update on the owning client
+	void FlushBatch();
+
+	UFUNCTION(Unreliable, Server, WithValidation, Category="Networking")
+	void Server_ReceiveClientAuthBatch(const TArray<FRepClientAuthBatchEntry>& Movements);
+
+	UFUNCTION(Reliable, Server, WithValidation, Category="Networking")
+	void Server_EndClientAuthBatch(const TArray<AReplicatedPhysicsActor*>& Actors);
+
+public:
+	// Turns batching off without removing the component, actors then use their own RPCs
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Networking")
+	bool bBatchClientAuthRPCs = true;
+
+	// Movements per unreliable RPC, larger batches are split so that a single RPC stays within a packet
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Networking", meta=(ClampMin="1"))
+	int32 MaxMovementsPerRPC = 16;
+
+private:
+	// Returns if the actor is owned by the same connection as this component, the server only accepts those
+	bool IsOwnedActor(const AReplicatedPhysicsActor* InActor) const;
+
+	UPROPERTY(Transient)
+	TArray<FRepClientAuthBatchEntry> PendingMovements;
+
+	UPROPERTY(Transient)
+	TArray<TObjectPtr<AReplicatedPhysicsActor>> PendingEnds;
+
+	TArray<FRepClientAuthBatchEntry> ScratchMovements;
+	TArray<AReplicatedPhysicsActor*> ScratchEnds;
+	FDelegateHandle BucketsDispatchedHandle;
+};
@@ -0,0 +1,21 @@
+﻿// Copyright Hitbox Games, LLC. All Rights Reserved.
+
+#pragma once
+
+#include "Iris/Serialization/NetSerializer.h"
+
+#include "ReplicatedPhysicsNetSerializers.generated.h"
+
+// Iris serializer of FRepMovementPhysics, quantizes into the same grid as its NetSerialize
+// FRepPhysicsAttachmentWithWeld has no serializer of its own, it is listed in the plugin's DefaultEngine.ini so that Iris
+// builds its per member descriptor instead, which already carries the object references, delta and equality
+USTRUCT()
+struct FRepMovementPhysicsNetSerializerConfig : public FNetSerializerConfig
+{
+	GENERATED_BODY()
+};
+
+namespace UE::Net
+{
+	UE_NET_DECLARE_SERIALIZER(FRepMovementPhysicsNetSerializer, REPLICATEDPHYSICS_API);
+}
@@ -12,9 +12,13 @@ public class ReplicatedPhysics : ModuleRules
 				"Core",
 				"CoreUObject",
 				"Engine",
+				"IrisCore",
 			}
 		);
 
+		// Defines UE_WITH_IRIS, the Iris serializers are always built and only used once the project runs Iris
+		SetupIrisSupport(Target);
+
         PublicIncludePathModuleNames.AddRange(
             new string[] {
             }